@@ -0,0 +1,134 @@
+#include "sim.h"
+#include "include/mpu6050.h"
+#include "include/joystick.h"
+#include "include/button.h"
+#include <math.h>
+#include <string.h>
+
+// ---- MPU6050: a gravidade vem da inclinação do roteiro ----
+
+// ruído determinístico (LCG), para a mesma execução dar sempre o mesmo resultado
+static uint32_t sensor_seed = 12345;
+
+static int16_t sensor_noise(void) {
+    if (sim_input.noise <= 0) return 0;
+    sensor_seed = sensor_seed * 1664525u + 1013904223u;
+    return (int16_t)((int)(sensor_seed >> 16) % (sim_input.noise + 1) - sim_input.noise / 2);
+}
+
+static int16_t sensor_clamp(float value) {
+    if (value > 32767.0f) return 32767;
+    if (value < -32768.0f) return -32768;
+    return (int16_t)lrintf(value);
+}
+
+bool mpu6050_init(mpu6050_t *mpu) {
+    memset(mpu, 0, sizeof(*mpu));
+    mpu->accel_scale = MPU6050_ACCEL_SCALE_2G;
+    mpu->gyro_scale = MPU6050_GYRO_SCALE_250DPS;
+    mpu->accel_scale_factor = mpu6050_get_accel_sensitivity(mpu->accel_scale);
+    mpu->gyro_scale_factor = mpu6050_get_gyro_sensitivity(mpu->gyro_scale);
+    mpu->initialized = true;
+    return true;
+}
+
+bool mpu6050_test_connection(mpu6050_t *mpu) {
+    return mpu->initialized;
+}
+
+// o barramento simulado aceita qualquer clock
+uint32_t mpu6050_set_baudrate(mpu6050_t *mpu, uint32_t baudrate) {
+    mpu->baudrate = baudrate;
+    return baudrate;
+}
+
+uint32_t mpu6050_probe_baudrate(mpu6050_t *mpu, uint32_t max_baudrate) {
+    return mpu6050_set_baudrate(mpu, max_baudrate);
+}
+
+// o sensor simulado nunca falha
+i2c_bus_stats_t mpu6050_i2c_stats(void) {
+    return (i2c_bus_stats_t){ 0 };
+}
+
+// o sensor simulado não tem erro de fábrica: os offsets só deslocam a leitura,
+// como os registradores de offset fariam
+bool mpu6050_read_raw(mpu6050_t *mpu, mpu6050_raw_data_t *raw_data) {
+    float x = sim_input.tilt_x;
+    float y = sim_input.tilt_y;
+    float z_sq = 1.0f - x * x - y * y;
+    float z = z_sq > 0.0f ? sqrtf(z_sq) : 0.0f;
+    float scale = mpu->accel_scale_factor;
+
+    // o eixo y do sensor é o contrário do eixo y da tela
+    raw_data->accel_x = (int16_t)(sensor_clamp(x * scale) + sensor_noise() - mpu->offsets.accel_x_offset);
+    raw_data->accel_y = (int16_t)(sensor_clamp(-y * scale) + sensor_noise() - mpu->offsets.accel_y_offset);
+    raw_data->accel_z = (int16_t)(sensor_clamp(z * scale) + sensor_noise() - mpu->offsets.accel_z_offset);
+    raw_data->gyro_x = (int16_t)(sensor_noise() - mpu->offsets.gyro_x_offset);
+    raw_data->gyro_y = (int16_t)(sensor_noise() - mpu->offsets.gyro_y_offset);
+    raw_data->gyro_z = (int16_t)(sensor_noise() - mpu->offsets.gyro_z_offset);
+    raw_data->temperature = 0;
+    return true;
+}
+
+void mpu6050_set_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets) {
+    mpu->offsets = *offsets;
+}
+
+void mpu6050_get_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets) {
+    *offsets = mpu->offsets;
+}
+
+bool mpu6050_set_hw_offsets(mpu6050_t *mpu, bool enable) {
+    mpu->hw_offsets = enable;
+    return true;
+}
+
+float mpu6050_get_accel_sensitivity(mpu6050_accel_scale_t scale) {
+    return 16384.0f / (float)(1 << scale);
+}
+
+float mpu6050_get_gyro_sensitivity(mpu6050_gyro_scale_t scale) {
+    static const float sensitivity[] = { 131.0f, 65.5f, 32.8f, 16.4f };
+    return sensitivity[scale & 3];
+}
+
+// ---- botões: os eventos vêm do roteiro ----
+
+void button_init(void) {}
+
+bool button_poll_event(button_event *event) {
+    return sim_next_button(event);
+}
+
+uint32_t button_dropped_events(void) {
+    return 0;
+}
+
+// ---- joystick ----
+
+bool joystick_init(joystick_t *joystick) {
+    memset(joystick, 0, sizeof(*joystick));
+    joystick->initialized = true;
+    return true;
+}
+
+void joystick_shutdown(joystick_t *joystick) {
+    joystick->initialized = false;
+}
+
+void joystick_calibrate_center(joystick_t *joystick) {
+    (void)joystick;
+}
+
+void joystick_read_raw(joystick_t *joystick, uint16_t *x, uint16_t *y) {
+    (void)joystick;
+    *x = (uint16_t)(2048 + sim_input.stick_x / 8);
+    *y = (uint16_t)(2048 + sim_input.stick_y / 8);
+}
+
+void joystick_read(joystick_t *joystick, int16_t *x, int16_t *y) {
+    (void)joystick;
+    *x = sim_input.stick_x;
+    *y = sim_input.stick_y;
+}
@@ -0,0 +1,18 @@
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include <stdint.h>
+
+enum clock_index {
+    clk_ref = 4,
+    clk_sys = 5,
+    clk_peri = 6
+};
+
+// o clock padrão do RP2040
+static inline uint32_t clock_get_hz(enum clock_index clock) {
+    (void)clock;
+    return 125000000;
+}
+
+#endif
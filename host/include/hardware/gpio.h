@@ -0,0 +1,27 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_IN  false
+#define GPIO_OUT true
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+// os pinos não fazem nada no PC
+static inline void gpio_init(unsigned int pin) { (void)pin; }
+static inline void gpio_set_dir(unsigned int pin, bool out) { (void)pin; (void)out; }
+static inline void gpio_put(unsigned int pin, bool value) { (void)pin; (void)value; }
+static inline bool gpio_get(unsigned int pin) { (void)pin; return true; }
+static inline void gpio_pull_up(unsigned int pin) { (void)pin; }
+static inline void gpio_disable_pulls(unsigned int pin) { (void)pin; }
+static inline void gpio_set_function(unsigned int pin, enum gpio_function fn) { (void)pin; (void)fn; }
+
+#endif
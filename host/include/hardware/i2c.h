@@ -0,0 +1,26 @@
+#ifndef HOST_HARDWARE_I2C_H
+#define HOST_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// o display SSD1306 é emulado no barramento (endereço 0x3C); os outros endereços não respondem
+typedef struct i2c_inst {
+    int index;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t host_i2c[2];
+#define i2c0 (&host_i2c[0])
+#define i2c1 (&host_i2c[1])
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+// no PC as transferências não travam; o tempo limite é ignorado
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us);
+
+#endif
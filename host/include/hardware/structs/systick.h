@@ -0,0 +1,16 @@
+#ifndef HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+#include <stdint.h>
+
+// registradores do SysTick sem contador de verdade (as medições dão 0 ciclos)
+typedef struct {
+    volatile uint32_t csr;
+    volatile uint32_t rvr;
+    volatile uint32_t cvr;
+    volatile uint32_t calib;
+} systick_hw_t;
+
+extern systick_hw_t *systick_hw;
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <stdint.h>
+#include <sched.h>
+
+// WFE vira ceder a vez para a outra thread; SEV não precisa fazer nada
+static inline void __wfe(void) { sched_yield(); }
+static inline void __sev(void) {}
+static inline void __dmb(void) { __sync_synchronize(); }
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif
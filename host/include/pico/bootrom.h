@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_BOOTROM_H
+#define HOST_PICO_BOOTROM_H
+
+#include <stdint.h>
+
+// no PC, voltar ao bootloader encerra a simulação
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask);
+
+#endif
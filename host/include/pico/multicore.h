@@ -0,0 +1,7 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+// o núcleo 1 vira uma thread
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+/*
+* Subconjunto do Pico SDK usado pelo jogo, para a compilação no PC
+* O tempo é virtual (avança a cada quadro e em sleep_ms), então a simulação
+* não depende da velocidade da máquina.
+*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "hardware/gpio.h"
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+#define __not_in_flash_func(x) x
+#define __aligned(x) __attribute__((aligned(x)))
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void tight_loop_contents(void);
+
+bool stdio_init_all(void);
+int putchar_raw(int c);
+void stdio_flush(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+#endif
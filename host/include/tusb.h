@@ -0,0 +1,13 @@
+#ifndef HOST_TUSB_H
+#define HOST_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// o CDC do USB vai para o arquivo de --telemetry (desconectado sem ele)
+bool tud_cdc_connected(void);
+uint32_t tud_cdc_write_available(void);
+uint32_t tud_cdc_write(const void *buffer, uint32_t bufsize);
+uint32_t tud_cdc_write_flush(void);
+
+#endif
@@ -0,0 +1,313 @@
+#include "sim.h"
+#include "display.h"
+#include "pico/stdlib.h"
+#include "pico/bootrom.h"
+#include "pico/flash.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/structs/systick.h"
+#include "tusb.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---- tempo virtual ----
+
+uint64_t sim_clock_us = 0;
+
+uint64_t time_us_64(void) {
+    return __atomic_load_n(&sim_clock_us, __ATOMIC_RELAXED);
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+void sleep_us(uint64_t us) {
+    __atomic_add_fetch(&sim_clock_us, us, __ATOMIC_RELAXED);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+void tight_loop_contents(void) {}
+
+// ---- stdio ----
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+int putchar_raw(int c) {
+    sim_raw_output(c);
+    return c;
+}
+
+void stdio_flush(void) {
+    fflush(stdout);
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    sleep_us(timeout_us);
+    return PICO_ERROR_TIMEOUT;
+}
+
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask) {
+    (void)gpio_activity_pin_mask;
+    (void)disable_interface_mask;
+    sim_exit("botao A (reinicio para o bootloader)", 0);
+}
+
+// ---- flash ----
+
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+// a flash começa apagada (a simulação preenche antes de chamar o jogo)
+__attribute__((constructor)) static void host_flash_erase_all(void) {
+    memset(host_flash, 0xFF, sizeof(host_flash));
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE || flash_offs + count > sizeof(host_flash)) {
+        sim_exit("flash_range_erase fora de setor", 3);
+    }
+    memset(host_flash + flash_offs, 0xFF, count);
+}
+
+// como na flash de verdade, programar só leva bits de 1 para 0
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE || flash_offs + count > sizeof(host_flash)) {
+        sim_exit("flash_range_program fora de pagina", 3);
+    }
+    for (size_t i = 0; i < count; i++) host_flash[flash_offs + i] &= data[i];
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void)enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
+
+bool flash_safe_execute_core_init(void) {
+    return true;
+}
+
+// ---- núcleo 1 ----
+
+static void *host_core1(void *entry) {
+    ((void (*)(void))entry)();
+    return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, host_core1, (void *)entry) != 0) {
+        sim_exit("nao foi possivel criar a thread do nucleo 1", 3);
+    }
+    pthread_detach(thread);
+}
+
+// ---- USB CDC (telemetria) ----
+
+bool tud_cdc_connected(void) {
+    return sim_telemetry_connected();
+}
+
+// a fila do TinyUSB no aparelho tem 256 bytes; aqui o PC a esvazia entre um quadro
+// e outro (sim_usb_drain), o que já é mais lento que o USB de verdade
+#define HOST_CDC_FIFO_SIZE 256
+
+static uint32_t cdc_queued;
+
+void sim_usb_drain(void) {
+    cdc_queued = 0;
+}
+
+uint32_t tud_cdc_write_available(void) {
+    return HOST_CDC_FIFO_SIZE - cdc_queued;
+}
+
+uint32_t tud_cdc_write(const void *buffer, uint32_t bufsize) {
+    uint32_t count = bufsize < tud_cdc_write_available() ? bufsize : tud_cdc_write_available();
+    sim_telemetry_output(buffer, count);
+    cdc_queued += count;
+    return count;
+}
+
+uint32_t tud_cdc_write_flush(void) {
+    return 0;
+}
+
+static systick_hw_t host_systick;
+systick_hw_t *systick_hw = &host_systick;
+
+// ---- I2C com o SSD1306 emulado ----
+
+#define SSD1306_ADDRESS 0x3C
+
+// com -DDISPLAY_SH1106 o controlador emulado é o SH1106: 132 colunas de memória, a
+// tela mostrando da coluna 2 à 129, e o ponteiro de escrita só no modo página
+#ifdef DISPLAY_SH1106
+#define SSD1306_RAM_WIDTH 132
+#else
+#define SSD1306_RAM_WIDTH 128
+#endif
+
+i2c_inst_t host_i2c[2] = { { 0, 0 }, { 1, 0 } };
+
+// estado do controlador: memória de vídeo, ponteiro de escrita e comando em andamento
+static struct {
+    uint8_t ram[8 * SSD1306_RAM_WIDTH];
+    int mode;              // 0 horizontal, 1 vertical, 2 página
+    int column, page;
+    int column_start, column_end;
+    int page_start, page_end;
+    uint8_t command;       // comando esperando argumentos
+    int pending;           // quantos argumentos faltam
+    uint8_t args[2];
+} ssd1306 = { .mode = 2, .column_end = 127, .page_end = 7 };
+
+const uint8_t *sim_display_ram(void) {
+#ifdef DISPLAY_SH1106
+    // só a parte visível, no formato de 128 colunas do SSD1306
+    static uint8_t visible[8 * 128];
+    for (int page = 0; page < 8; page++) {
+        memcpy(&visible[page * 128], &ssd1306.ram[page * SSD1306_RAM_WIDTH + SH1106_COLUMN_OFFSET], 128);
+    }
+    return visible;
+#else
+    return ssd1306.ram;
+#endif
+}
+
+// argumentos que cada comando espera
+static int ssd1306_argument_count(uint8_t command) {
+    switch (command) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+static void ssd1306_execute(uint8_t command, const uint8_t *args) {
+    if (command == 0x20) {
+#ifndef DISPLAY_SH1106
+        ssd1306.mode = args[0] & 3;
+#endif
+    } else if (command == 0x21) {
+        ssd1306.column_start = ssd1306.column = args[0] & 127;
+        ssd1306.column_end = args[1] & 127;
+    } else if (command == 0x22) {
+        ssd1306.page_start = ssd1306.page = args[0] & 7;
+        ssd1306.page_end = args[1] & 7;
+    } else if (command >= 0xB0 && command <= 0xB7) {
+        ssd1306.page = command & 7;
+    } else if (command <= 0x0F) {
+        ssd1306.column = (ssd1306.column & 0xF0) | command;
+    } else if (command >= 0x10 && command <= 0x1F) {
+        ssd1306.column = ((ssd1306.column & 0x0F) | ((command & 0x0F) << 4)) % SSD1306_RAM_WIDTH;
+    }
+}
+
+static void ssd1306_command_byte(uint8_t value) {
+    if (ssd1306.pending > 0) {
+        int count = ssd1306_argument_count(ssd1306.command);
+        ssd1306.args[count - ssd1306.pending] = value;
+        if (--ssd1306.pending == 0) ssd1306_execute(ssd1306.command, ssd1306.args);
+        return;
+    }
+
+    ssd1306.command = value;
+    ssd1306.pending = ssd1306_argument_count(value);
+    if (ssd1306.pending == 0) ssd1306_execute(value, NULL);
+}
+
+// escreve no ponteiro atual e avança como o controlador (a janela de 0x21/0x22 vale
+// nos modos horizontal e vertical; no modo página a coluna só dá a volta)
+static void ssd1306_data_byte(uint8_t value) {
+    ssd1306.ram[ssd1306.page * SSD1306_RAM_WIDTH + ssd1306.column] = value;
+
+    if (ssd1306.mode == 2) {
+        ssd1306.column = (ssd1306.column + 1) % SSD1306_RAM_WIDTH;
+    } else if (ssd1306.mode == 0) {
+        if (ssd1306.column++ >= ssd1306.column_end) {
+            ssd1306.column = ssd1306.column_start;
+            ssd1306.page = ssd1306.page >= ssd1306.page_end ? ssd1306.page_start : ssd1306.page + 1;
+        }
+    } else {
+        if (ssd1306.page++ >= ssd1306.page_end) {
+            ssd1306.page = ssd1306.page_start;
+            ssd1306.column = ssd1306.column >= ssd1306.column_end ? ssd1306.column_start : ssd1306.column + 1;
+        }
+    }
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+void i2c_deinit(i2c_inst_t *i2c) {
+    i2c->baudrate = 0;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+// o primeiro byte é o de controle: bit 6 indica dados, senão são comandos
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    if (i2c->baudrate == 0 || addr != SSD1306_ADDRESS) return PICO_ERROR_GENERIC;
+    if (len == 0) return 0;
+
+    // falha pedida pelo roteiro: o display não confirma e nada chega nele
+    if (sim_input.i2c_failures > 0) {
+        sim_input.i2c_failures--;
+        return PICO_ERROR_GENERIC;
+    }
+
+    bool data = (src[0] & 0x40) != 0;
+    for (size_t i = 1; i < len; i++) {
+        if (data) {
+            ssd1306_data_byte(src[i]);
+        } else {
+            ssd1306_command_byte(src[i]);
+        }
+    }
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)dst;
+    (void)len;
+    (void)nostop;
+    return PICO_ERROR_GENERIC;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us) {
+    (void)timeout_us;
+    return i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
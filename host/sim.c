@@ -0,0 +1,412 @@
+#include "sim.h"
+#include "include/display.h"
+#include "include/joystick.h"
+#include "include/crc32.h"
+#include "include/replay_storage.h"
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+* Uso: fluid-simulation-host [opções]
+*   --script ARQ     roteiro de entradas (veja host/scripts/)
+*   --frames N       para depois de N quadros (padrão 1000; 0 = sem limite)
+*   --frame-us US    tempo virtual de cada quadro (padrão 25000, o envio ao display a 400 kHz)
+*   --pbm DIR        grava os quadros como DIR/frame_NNNNN.pbm
+*   --ascii          desenha os quadros no terminal
+*   --every K        só grava/desenha um a cada K quadros
+*   --noise LSB      ruído do sensor simulado
+*   --replay ARQ     gravação (de replay_storage_dump) posta na flash antes de começar
+*   --dump ARQ       arquivo que recebe a gravação enviada pelo "USB"
+*   --telemetry ARQ  arquivo que recebe a telemetria binária do CDC
+*   --timeout S      aborta se a execução passar de S segundos reais (padrão 60)
+*
+* Formato do roteiro, uma entrada por linha ('#' começa um comentário):
+*   <quadro> tilt <x> <y>       inclinação em g (y positivo leva a bola para baixo)
+*   <quadro> stick <x> <y>      joystick em -1..1 (y positivo para cima, como no aparelho)
+*   <quadro> press|release|long|repeat <A|B|J>
+*   <quadro> click <A|B|J>      aperta e solta
+*   <quadro> hold <A|B|J>       aperta, segura até o toque longo e solta
+*   <quadro> i2c-fail <n>       as próximas n escritas no display recebem NACK
+*   <quadro> quit               encerra a simulação
+*/
+
+int game_main(void);
+
+sim_input_t sim_input;
+uint32_t sim_frames = 0;
+
+// ---- opções ----
+
+static struct {
+    const char *script;
+    uint32_t max_frames;
+    uint32_t frame_us;
+    const char *pbm_dir;
+    bool ascii;
+    uint32_t every;
+    const char *replay;
+    const char *dump;
+    const char *telemetry;
+    unsigned timeout_s;
+} options = { .max_frames = 1000, .frame_us = 25000, .every = 1, .timeout_s = 60 };
+
+static FILE *dump_file;
+static FILE *telemetry_file;
+
+// ---- roteiro ----
+
+typedef enum {
+    SCRIPT_TILT,
+    SCRIPT_STICK,
+    SCRIPT_BUTTON,
+    SCRIPT_I2C_FAIL,
+    SCRIPT_QUIT
+} script_kind_t;
+
+typedef struct {
+    uint32_t frame;
+    script_kind_t kind;
+    float x, y;
+    button_id button;
+    button_action action;
+} script_entry_t;
+
+#define SIM_MAX_SCRIPT 4096
+#define SIM_MAX_PENDING 64
+
+static script_entry_t script[SIM_MAX_SCRIPT];
+static int script_count;
+static int script_next;
+
+// eventos liberados para o quadro atual, na ordem do roteiro
+static button_event pending[SIM_MAX_PENDING];
+static int pending_head, pending_tail;
+
+static bool script_button(const char *name, button_id *button) {
+    if (strcmp(name, "A") == 0) *button = BUTTON_A;
+    else if (strcmp(name, "B") == 0) *button = BUTTON_B;
+    else if (strcmp(name, "J") == 0) *button = BUTTON_JOYSTICK;
+    else return false;
+    return true;
+}
+
+static bool script_add(uint32_t frame, script_kind_t kind, float x, float y, button_id button, button_action action) {
+    if (script_count >= SIM_MAX_SCRIPT) return false;
+    script[script_count++] = (script_entry_t){ frame, kind, x, y, button, action };
+    return true;
+}
+
+static void script_load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "sim: nao foi possivel abrir %s\n", path);
+        exit(2);
+    }
+
+    char line[256];
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        unsigned frame;
+        char command[16], arg[16];
+        float x, y;
+        button_id button;
+        int fields = sscanf(line, "%u %15s", &frame, command);
+        if (fields <= 0) continue;
+
+        bool ok = fields == 2;
+        if (!ok) {
+            // linha em branco
+        } else if (strcmp(command, "tilt") == 0 || strcmp(command, "stick") == 0) {
+            ok = sscanf(line, "%*u %*s %f %f", &x, &y) == 2 &&
+                 script_add(frame, command[0] == 't' ? SCRIPT_TILT : SCRIPT_STICK, x, y, BUTTON_NONE, BUTTON_PRESS);
+        } else if (strcmp(command, "i2c-fail") == 0) {
+            ok = sscanf(line, "%*u %*s %f", &x) == 1 &&
+                 script_add(frame, SCRIPT_I2C_FAIL, x, 0, BUTTON_NONE, BUTTON_PRESS);
+        } else if (strcmp(command, "quit") == 0) {
+            ok = script_add(frame, SCRIPT_QUIT, 0, 0, BUTTON_NONE, BUTTON_PRESS);
+        } else if (sscanf(line, "%*u %*s %15s", arg) == 1 && script_button(arg, &button)) {
+            if (strcmp(command, "press") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_PRESS);
+            } else if (strcmp(command, "release") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_RELEASE);
+            } else if (strcmp(command, "long") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_LONG_PRESS);
+            } else if (strcmp(command, "repeat") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_REPEAT);
+            } else if (strcmp(command, "click") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_PRESS) &&
+                     script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_RELEASE);
+            } else if (strcmp(command, "hold") == 0) {
+                ok = script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_PRESS) &&
+                     script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_LONG_PRESS) &&
+                     script_add(frame, SCRIPT_BUTTON, 0, 0, button, BUTTON_RELEASE);
+            } else {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            fprintf(stderr, "sim: %s:%d: entrada invalida\n", path, number);
+            exit(2);
+        }
+    }
+    fclose(file);
+}
+
+// Aplica as entradas do roteiro até o quadro atual
+static void script_apply(void) {
+    while (script_next < script_count && script[script_next].frame <= sim_frames) {
+        const script_entry_t *entry = &script[script_next++];
+        switch (entry->kind) {
+            case SCRIPT_TILT:
+                sim_input.tilt_x = entry->x;
+                sim_input.tilt_y = entry->y;
+                break;
+            case SCRIPT_STICK:
+                sim_input.stick_x = (int16_t)(entry->x * JOYSTICK_FULL_SCALE);
+                sim_input.stick_y = (int16_t)(entry->y * JOYSTICK_FULL_SCALE);
+                break;
+            case SCRIPT_BUTTON:
+                if (pending_tail - pending_head < SIM_MAX_PENDING) {
+                    pending[pending_tail++ % SIM_MAX_PENDING] = (button_event){
+                        .time_us = (uint32_t)sim_clock_us, .button = entry->button, .action = entry->action,
+                    };
+                }
+                break;
+            case SCRIPT_I2C_FAIL:
+                sim_input.i2c_failures = (int)entry->x;
+                break;
+            case SCRIPT_QUIT:
+                sim_exit("fim do roteiro", 0);
+        }
+    }
+}
+
+bool sim_next_button(button_event *event) {
+    if (pending_head == pending_tail) return false;
+    *event = pending[pending_head++ % SIM_MAX_PENDING];
+    return true;
+}
+
+// ---- quadros ----
+
+static uint32_t frames_digest;
+static struct timespec wall_start;
+
+static void frame_write_pbm(const uint8_t *ram) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05lu.pbm", options.pbm_dir, (unsigned long)sim_frames);
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "sim: nao foi possivel criar %s\n", path);
+        exit(2);
+    }
+
+    // PBM binário: 1 bit por pixel, 1 = preto; o pixel aceso fica branco
+    fprintf(file, "P4\n%d %d\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (int x = 0; x < DISPLAY_WIDTH; x += 8) {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                bool on = ram[(y / 8) * DISPLAY_WIDTH + x + bit] & (1 << (y % 8));
+                if (!on) packed |= (uint8_t)(0x80 >> bit);
+            }
+            fputc(packed, file);
+        }
+    }
+    fclose(file);
+}
+
+// duas linhas da tela por linha do terminal, com meios blocos
+static void frame_write_ascii(const uint8_t *ram) {
+    static const char *blocks[4] = { " ", "▀", "▄", "█" };
+
+    printf("quadro %lu\n", (unsigned long)sim_frames);
+    for (int y = 0; y < DISPLAY_HEIGHT; y += 2) {
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            int top = (ram[(y / 8) * DISPLAY_WIDTH + x] >> (y % 8)) & 1;
+            int bottom = (ram[((y + 1) / 8) * DISPLAY_WIDTH + x] >> ((y + 1) % 8)) & 1;
+            fputs(blocks[top | (bottom << 1)], stdout);
+        }
+        fputc('\n', stdout);
+    }
+}
+
+void sim_frame_done(void) {
+    const uint8_t *ram = sim_display_ram();
+
+    // resumo de todos os quadros mostrados: qualquer mudança de comportamento muda o valor
+    frames_digest = crc32(ram, DISPLAY_WIDTH * DISPLAY_HEIGHT / 8) ^ (frames_digest * 31u);
+
+    if (sim_frames % options.every == 0) {
+        if (options.pbm_dir) frame_write_pbm(ram);
+        if (options.ascii) frame_write_ascii(ram);
+    }
+
+    sim_frames++;
+    sleep_us(options.frame_us);
+    sim_usb_drain();
+
+    if (options.max_frames && sim_frames >= options.max_frames) sim_exit("limite de quadros", 0);
+    script_apply();
+}
+
+// o jogo chama display_update; o ligador desvia para cá (-Wl,--wrap=display_update)
+void __real_display_update(display *disp);
+
+void __wrap_display_update(display *disp) {
+    __real_display_update(disp);
+    sim_frame_done();
+}
+
+void sim_raw_output(int c) {
+    fputc(c, dump_file ? dump_file : stdout);
+}
+
+bool sim_telemetry_connected(void) {
+    return telemetry_file != NULL;
+}
+
+void sim_telemetry_output(const void *data, uint32_t length) {
+    if (telemetry_file) fwrite(data, 1, length, telemetry_file);
+}
+
+void sim_exit(const char *reason, int status) {
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall = (double)(wall_end.tv_sec - wall_start.tv_sec) + (double)(wall_end.tv_nsec - wall_start.tv_nsec) * 1e-9;
+
+    fflush(stdout);
+    if (dump_file) fclose(dump_file);
+    if (telemetry_file) fclose(telemetry_file);
+    printf("sim: %s\n", reason);
+    printf("sim: %lu quadros, %.2f s simulados, %.3f s reais (%.0f quadros/s), resumo %08lx\n",
+           (unsigned long)sim_frames, (double)sim_clock_us * 1e-6, wall,
+           wall > 0 ? (double)sim_frames / wall : 0.0, (unsigned long)frames_digest);
+    fflush(stdout);
+    _exit(status);
+}
+
+static void sim_timeout(int signal) {
+    (void)signal;
+    sim_exit("tempo esgotado", 4);
+}
+
+// ---- gravação ----
+
+// aceita o arquivo puro ou a captura do USB com a linha "REPLAY <bytes>" antes
+static void replay_load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "sim: nao foi possivel abrir %s\n", path);
+        exit(2);
+    }
+
+    static uint8_t bytes[REPLAY_FLASH_SIZE + 64];
+    size_t length = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+
+    size_t start = 0;
+    uint32_t magic = REPLAY_STORAGE_MAGIC;
+    while (start + sizeof(magic) <= length && memcmp(bytes + start, &magic, sizeof(magic)) != 0) start++;
+
+    replay_container_t container;
+    if (start + sizeof(container) > length) {
+        fprintf(stderr, "sim: %s nao contem uma gravacao\n", path);
+        exit(2);
+    }
+    memcpy(&container, bytes + start, sizeof(container));
+    if (container.length > REPLAY_FLASH_MAX_STREAM || start + sizeof(container) + container.length > length) {
+        fprintf(stderr, "sim: gravacao incompleta em %s\n", path);
+        exit(2);
+    }
+
+    // mesmo lugar e formato que replay_storage_save usa na flash
+    uint32_t offset = PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE - REPLAY_FLASH_SIZE;
+    memcpy(host_flash + offset, &container, sizeof(container));
+    memcpy(host_flash + offset + FLASH_PAGE_SIZE, bytes + start + sizeof(container), container.length);
+}
+
+static void usage(void) {
+    fprintf(stderr, "uso: fluid-simulation-host [--script ARQ] [--frames N] [--frame-us US] [--pbm DIR]\n"
+                    "                           [--ascii] [--every K] [--noise LSB] [--replay ARQ]\n"
+                    "                           [--dump ARQ] [--telemetry ARQ] [--timeout S]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        bool takes_value = true;
+
+        if (strcmp(arg, "--ascii") == 0) {
+            options.ascii = true;
+            takes_value = false;
+        } else if (!value) {
+            usage();
+        } else if (strcmp(arg, "--script") == 0) {
+            options.script = value;
+        } else if (strcmp(arg, "--frames") == 0) {
+            options.max_frames = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--frame-us") == 0) {
+            options.frame_us = (uint32_t)strtoul(value, NULL, 10);
+        } else if (strcmp(arg, "--pbm") == 0) {
+            options.pbm_dir = value;
+        } else if (strcmp(arg, "--every") == 0) {
+            options.every = (uint32_t)strtoul(value, NULL, 10);
+            if (options.every == 0) options.every = 1;
+        } else if (strcmp(arg, "--noise") == 0) {
+            sim_input.noise = atoi(value);
+        } else if (strcmp(arg, "--replay") == 0) {
+            options.replay = value;
+        } else if (strcmp(arg, "--dump") == 0) {
+            options.dump = value;
+        } else if (strcmp(arg, "--telemetry") == 0) {
+            options.telemetry = value;
+        } else if (strcmp(arg, "--timeout") == 0) {
+            options.timeout_s = (unsigned)strtoul(value, NULL, 10);
+        } else {
+            usage();
+        }
+        if (takes_value) i++;
+    }
+
+    if (options.script) script_load(options.script);
+    if (options.replay) replay_load(options.replay);
+    if (options.dump) {
+        dump_file = fopen(options.dump, "wb");
+        if (!dump_file) {
+            fprintf(stderr, "sim: nao foi possivel criar %s\n", options.dump);
+            exit(2);
+        }
+    }
+    if (options.telemetry) {
+        telemetry_file = fopen(options.telemetry, "wb");
+        if (!telemetry_file) {
+            fprintf(stderr, "sim: nao foi possivel criar %s\n", options.telemetry);
+            exit(2);
+        }
+    }
+
+    // um laço travado (ex.: a tela de erro do jogo) não pode segurar o CI para sempre
+    signal(SIGALRM, sim_timeout);
+    alarm(options.timeout_s);
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    script_apply();
+    game_main();
+    sim_exit("fim do jogo", 0);
+}
@@ -0,0 +1,55 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/button.h"
+
+/*
+* Simulador do jogo no PC, sem hardware
+* O laço de src/main.c roda sem alterações; por baixo dele:
+* - platform.c: tempo virtual, flash em RAM, núcleo 1 como thread e o display
+*   SSD1306 emulado no barramento I2C
+* - devices.c: sensor, botões e joystick alimentados pelo roteiro
+* - sim.c: opções, roteiro, saída dos quadros e o resumo final
+*/
+
+// entradas atuais do roteiro
+typedef struct {
+    float tilt_x;       // inclinação em g, no sentido da tela (y positivo = para baixo)
+    float tilt_y;
+    int16_t stick_x;    // joystick em ±JOYSTICK_FULL_SCALE
+    int16_t stick_y;
+    int noise;          // ruído do sensor em LSB (pico a pico)
+    int i2c_failures;   // próximas escritas no display que vão receber NACK
+} sim_input_t;
+
+extern sim_input_t sim_input;
+
+// relógio virtual em microssegundos e quadros já mostrados
+extern uint64_t sim_clock_us;
+extern uint32_t sim_frames;
+
+// próximo evento de botão do roteiro, já liberado para o quadro atual
+bool sim_next_button(button_event *event);
+
+// memória de vídeo do SSD1306 emulado (8 páginas de 128 bytes)
+const uint8_t *sim_display_ram(void);
+
+// chamado a cada display_update; avança o relógio, grava o quadro e aplica o roteiro
+void sim_frame_done(void);
+
+// para onde vão os bytes de putchar_raw (a gravação enviada pelo "USB")
+void sim_raw_output(int c);
+
+// destino da telemetria do CDC (arquivo de --telemetry); sem ele o "USB" fica desconectado
+bool sim_telemetry_connected(void);
+void sim_telemetry_output(const void *data, uint32_t length);
+
+// o PC leu a fila do CDC (chamado a cada quadro)
+void sim_usb_drain(void);
+
+// termina a simulação imprimindo o resumo
+void sim_exit(const char *reason, int status) __attribute__((noreturn));
+
+#endif
@@ -1,65 +1,135 @@
 #include "button.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
-#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "hardware/timer.h"
 
-static volatile button_event current_event = BUTTON_NONE;
+#define BUTTON_QUEUE_MASK (BUTTON_QUEUE_SIZE - 1)
 
-static absolute_time_t last_press_time_a = 0;
-static absolute_time_t last_press_time_b = 0;
-static absolute_time_t last_press_time_joystick = 0;
+_Static_assert((BUTTON_QUEUE_SIZE & BUTTON_QUEUE_MASK) == 0, "BUTTON_QUEUE_SIZE precisa ser potência de 2");
 
-static void gpio_callback(uint gpio, uint32_t events) {
-    absolute_time_t now = get_absolute_time();
+// fila circular de um produtor (timer de amostragem) e um consumidor (laço principal)
+// os índices crescem livremente e só o dono de cada um escreve nele, então não
+// é preciso desligar interrupções para ler ou escrever na fila
+static button_event queue[BUTTON_QUEUE_SIZE];
+static volatile uint32_t queue_head = 0; // escrito apenas pelo produtor
+static volatile uint32_t queue_tail = 0; // escrito apenas pelo consumidor
+static volatile uint32_t queue_dropped = 0;
 
-    if (gpio == BUTTON_A_PIN) {
-        if (absolute_time_diff_us(last_press_time_a, now) < DEBOUNCE_MS * 1000) {
-            return;
-        }
-        last_press_time_a = now;
-        current_event = BUTTON_A;
+// tabela de entradas: para adicionar um botão basta incluir uma linha
+typedef struct {
+    uint pin;
+    button_id id;
+} button_pin;
+
+static const button_pin button_pins[] = {
+    {BUTTON_A_PIN, BUTTON_A},
+    {BUTTON_B_PIN, BUTTON_B},
+    {BUTTON_JOYSTICK_PIN, BUTTON_JOYSTICK},
+};
+
+#define BUTTON_COUNT (sizeof(button_pins) / sizeof(button_pins[0]))
+
+#define BUTTON_LONG_PRESS_TICKS (BUTTON_LONG_PRESS_MS * 1000 / BUTTON_SAMPLE_US)
+#define BUTTON_REPEAT_TICKS     (BUTTON_REPEAT_MS * 1000 / BUTTON_SAMPLE_US)
+
+// estado da máquina de debounce de cada botão
+typedef struct {
+    uint8_t integrator;   // 0 = solto estável, BUTTON_DEBOUNCE_SAMPLES = pressionado estável
+    bool pressed;
+    uint32_t held_ticks;  // amostras desde o press aceito
+} button_state;
+
+static button_state buttons[BUTTON_COUNT];
+static repeating_timer_t sample_timer;
+
+// coloca um evento na fila (chamado apenas pelo timer)
+static void queue_push(button_id id, button_action action, uint32_t time_us) {
+    uint32_t head = queue_head;
+
+    if (head - queue_tail >= BUTTON_QUEUE_SIZE) {
+        queue_dropped++;
+        return;
     }
 
-    if (gpio == BUTTON_B_PIN) {
-        if (absolute_time_diff_us(last_press_time_b, now) < DEBOUNCE_MS * 1000) {
-            return;
-        }
-        last_press_time_b = now;
-        current_event = BUTTON_B;
+    button_event *slot = &queue[head & BUTTON_QUEUE_MASK];
+    slot->time_us = time_us;
+    slot->button = id;
+    slot->action = action;
+
+    // o evento precisa estar escrito antes do consumidor ver o novo índice
+    __dmb();
+    queue_head = head + 1;
+}
+
+// avança a máquina de estados de um botão com uma nova amostra
+static void button_sample(button_state *button, button_id id, bool level, uint32_t now) {
+    // integrador: sobe enquanto pressionado, desce enquanto solto, saturando nos extremos
+    if (level) {
+        if (button->integrator < BUTTON_DEBOUNCE_SAMPLES) button->integrator++;
+    } else {
+        if (button->integrator > 0) button->integrator--;
     }
 
-    if (gpio == BUTTON_JOYSTICK_PIN) {
-        if (absolute_time_diff_us(last_press_time_joystick, now) < DEBOUNCE_MS * 1000) {
-            return;
+    if (!button->pressed && button->integrator == BUTTON_DEBOUNCE_SAMPLES) {
+        button->pressed = true;
+        button->held_ticks = 0;
+        queue_push(id, BUTTON_PRESS, now);
+    } else if (button->pressed && button->integrator == 0) {
+        button->pressed = false;
+        queue_push(id, BUTTON_RELEASE, now);
+    } else if (button->pressed) {
+        button->held_ticks++;
+        if (button->held_ticks == BUTTON_LONG_PRESS_TICKS) {
+            queue_push(id, BUTTON_LONG_PRESS, now);
+        } else if (button->held_ticks > BUTTON_LONG_PRESS_TICKS &&
+                   (button->held_ticks - BUTTON_LONG_PRESS_TICKS) % BUTTON_REPEAT_TICKS == 0) {
+            queue_push(id, BUTTON_REPEAT, now);
         }
-        last_press_time_joystick = now;
-        current_event = BUTTON_JOYSTICK;
     }
 }
 
-void button_init(void) {
-    gpio_init(BUTTON_A_PIN);
-    gpio_set_dir(BUTTON_A_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_A_PIN);
+// amostra todos os pinos de uma vez a cada BUTTON_SAMPLE_US
+static bool sample_timer_callback(repeating_timer_t *timer) {
+    uint32_t now = time_us_32();
+    uint32_t levels = gpio_get_all();
+
+    for (uint i = 0; i < BUTTON_COUNT; i++) {
+        // os botões têm pull-up, então nível baixo é pressionado
+        bool level = !(levels & (1u << button_pins[i].pin));
+        button_sample(&buttons[i], button_pins[i].id, level, now);
+    }
+    return true;
+}
 
-    gpio_init(BUTTON_B_PIN);
-    gpio_set_dir(BUTTON_B_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_B_PIN);
+void button_init(void) {
+    for (uint i = 0; i < BUTTON_COUNT; i++) {
+        gpio_init(button_pins[i].pin);
+        gpio_set_dir(button_pins[i].pin, GPIO_IN);
+        gpio_pull_up(button_pins[i].pin);
 
-    gpio_init(BUTTON_JOYSTICK_PIN);
-    gpio_set_dir(BUTTON_JOYSTICK_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON_JOYSTICK_PIN);
+        buttons[i].integrator = 0;
+        buttons[i].pressed = false;
+        buttons[i].held_ticks = 0;
+    }
 
-    gpio_set_irq_enabled_with_callback(BUTTON_A_PIN, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
-    gpio_set_irq_enabled(BUTTON_B_PIN, GPIO_IRQ_EDGE_FALL, true);
-    gpio_set_irq_enabled(BUTTON_JOYSTICK_PIN, GPIO_IRQ_EDGE_FALL, true);
+    // período negativo: intervalo medido entre inícios de callback, sem acumular atraso
+    add_repeating_timer_us(-BUTTON_SAMPLE_US, sample_timer_callback, NULL, &sample_timer);
 }
 
-button_event button_get_event(void) {
-    return current_event;
+bool button_poll_event(button_event *event) {
+    uint32_t tail = queue_tail;
+
+    if (tail == queue_head) return false;
+
+    // lê o evento só depois de ver o índice publicado pelo produtor
+    __dmb();
+    *event = queue[tail & BUTTON_QUEUE_MASK];
+    __dmb();
+    queue_tail = tail + 1;
+    return true;
 }
 
-void button_clear_event(void) {
-    current_event = BUTTON_NONE;
-}
\ No newline at end of file
+uint32_t button_dropped_events(void) {
+    return queue_dropped;
+}
@@ -1,26 +1,54 @@
 #ifndef BUTTON_H
 #define BUTTON_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define BUTTON_A_PIN        5
 #define BUTTON_B_PIN        6
 #define BUTTON_JOYSTICK_PIN 22
 
-#define DEBOUNCE_MS         200
+// os botões são amostrados por um timer periódico; uma mudança só é aceita
+// depois de BUTTON_DEBOUNCE_SAMPLES amostras seguidas no novo nível
+#define BUTTON_SAMPLE_US        1000
+#define BUTTON_DEBOUNCE_SAMPLES 5
+
+// tempo segurando até gerar BUTTON_LONG_PRESS, e intervalo entre BUTTON_REPEAT
+#define BUTTON_LONG_PRESS_MS 600
+#define BUTTON_REPEAT_MS     150
+
+// capacidade da fila de eventos (precisa ser potência de 2)
+#define BUTTON_QUEUE_SIZE   16
 
 typedef enum {
     BUTTON_NONE,
     BUTTON_A,
     BUTTON_B,
     BUTTON_JOYSTICK
+} button_id;
+
+typedef enum {
+    BUTTON_PRESS,
+    BUTTON_RELEASE,
+    BUTTON_LONG_PRESS,
+    BUTTON_REPEAT
+} button_action;
+
+// evento com o instante (time_us_32) em que foi detectado
+typedef struct {
+    uint32_t time_us;
+    button_id button;
+    button_action action;
 } button_event;
 
-// inicializa as gpio e as interrupções
+// inicializa as gpio (entrada com pull-up) e liga o timer que amostra os botões
+// a cada BUTTON_SAMPLE_US e faz o debounce
 void button_init(void);
 
-// le o ultimo evento registrado
-button_event button_get_event(void);
+// retira o evento mais antigo da fila; retorna false se a fila estiver vazia
+bool button_poll_event(button_event *event);
 
-// limpa o evento atual
-void button_clear_event(void);
+// quantidade de eventos descartados porque a fila estava cheia
+uint32_t button_dropped_events(void);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,295 @@
+#include "collision.h"
+
+// a equação do segundo grau dos cantos é resolvida em Q.8 para caber em 64 bits
+#define COLLISION_QUAD_BITS 8
+#define COLLISION_QUAD_SHIFT (PHYSICS_FRAC_BITS - COLLISION_QUAD_BITS)
+
+_Static_assert(PHYSICS_FRAC_BITS >= COLLISION_QUAD_BITS, "a colisão precisa de pelo menos 8 bits fracionários");
+
+static inline fix_t fix_abs(fix_t value) {
+    return value < 0 ? -value : value;
+}
+
+static inline fix_t fix_clamp(fix_t value, fix_t low, fix_t high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+// a / b em ponto fixo
+static inline fix_t fix_div(int64_t a, int64_t b) {
+    return (fix_t)((a * FIX_ONE) / b);
+}
+
+// instante em que o movimento atinge um plano, limitado a ±2 para não estourar 32 bits
+static inline fix_t collision_plane_time(int64_t distance, fix_t speed) {
+    int64_t t = (distance * FIX_ONE) / speed;
+    if (t > 2 * FIX_ONE) return 2 * FIX_ONE;
+    if (t < -2 * FIX_ONE) return -2 * FIX_ONE;
+    return (fix_t)t;
+}
+
+typedef enum {
+    COLLISION_OVERLAP_NONE,
+    COLLISION_OVERLAP_HIT,
+    COLLISION_OVERLAP_SEPARATING
+} collision_overlap_t;
+
+// Raiz quadrada inteira bit a bit (sem divisão)
+uint32_t collision_isqrt64(uint64_t value) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > value) bit >>= 2;
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+// O círculo já começa encostado/dentro do retângulo: contato imediato,
+// a menos que ele já esteja se afastando
+static collision_overlap_t collision_overlap(fix_t x, fix_t y, fix_t dx, fix_t dy, fix_t radius,
+                              fix_t bx0, fix_t by0, fix_t bx1, fix_t by1, collision_hit_t *hit) {
+    fix_t qx = fix_clamp(x, bx0, bx1);
+    fix_t qy = fix_clamp(y, by0, by1);
+    int64_t ox = x - qx;
+    int64_t oy = y - qy;
+    int64_t dist_sq = ox * ox + oy * oy;
+
+    if (dist_sq >= (int64_t)radius * radius) return COLLISION_OVERLAP_NONE;
+
+    if (dist_sq > 0) {
+        if (ox * dx + oy * dy >= 0) return COLLISION_OVERLAP_SEPARATING;
+
+        fix_t dist = (fix_t)collision_isqrt64((uint64_t)dist_sq);
+        hit->normal_x = fix_div(ox, dist);
+        hit->normal_y = fix_div(oy, dist);
+    } else {
+        // centro dentro do retângulo: sai pela face mais próxima
+        fix_t left = x - bx0, right = bx1 - x, top = y - by0, bottom = by1 - y;
+        fix_t best = left;
+        hit->normal_x = -FIX_ONE;
+        hit->normal_y = 0;
+        if (right < best) { best = right; hit->normal_x = FIX_ONE; hit->normal_y = 0; }
+        if (top < best) { best = top; hit->normal_x = 0; hit->normal_y = -FIX_ONE; }
+        if (bottom < best) { hit->normal_x = 0; hit->normal_y = FIX_ONE; }
+
+        if ((int64_t)dx * hit->normal_x + (int64_t)dy * hit->normal_y > 0) return COLLISION_OVERLAP_SEPARATING;
+    }
+
+    hit->toi = 0;
+    return COLLISION_OVERLAP_HIT;
+}
+
+// Raio contra o círculo de raio r centrado no canto (cx, cy)
+static bool collision_sweep_corner(fix_t x, fix_t y, fix_t dx, fix_t dy, fix_t radius,
+                                   fix_t cx, fix_t cy, collision_hit_t *hit) {
+    int64_t mx = (x - cx) >> COLLISION_QUAD_SHIFT;
+    int64_t my = (y - cy) >> COLLISION_QUAD_SHIFT;
+    int64_t vx = dx >> COLLISION_QUAD_SHIFT;
+    int64_t vy = dy >> COLLISION_QUAD_SHIFT;
+    int64_t r = radius >> COLLISION_QUAD_SHIFT;
+
+    // |m + t v|² = r²  ->  a t² + 2 b t + c = 0
+    int64_t a = vx * vx + vy * vy;
+    int64_t b = mx * vx + my * vy;
+    int64_t c = mx * mx + my * my - r * r;
+
+    if (a == 0 || b >= 0) return false;  // parado ou se afastando do canto
+
+    int64_t disc = b * b - a * c;
+    if (disc < 0) return false;
+
+    int64_t t_num = -b - (int64_t)collision_isqrt64((uint64_t)disc);
+    if (t_num < 0 || t_num > a) return false;
+
+    fix_t t = fix_div(t_num, a);
+    fix_t px = x + fix_mul(dx, t);
+    fix_t py = y + fix_mul(dy, t);
+
+    hit->toi = t;
+    hit->normal_x = fix_div(px - cx, radius);
+    hit->normal_y = fix_div(py - cy, radius);
+    return true;
+}
+
+// Varre o círculo contra um retângulo sólido [bx0, bx1] x [by0, by1]
+static bool collision_sweep_box(fix_t x, fix_t y, fix_t dx, fix_t dy, fix_t radius,
+                                fix_t bx0, fix_t by0, fix_t bx1, fix_t by1, collision_hit_t *hit) {
+    collision_overlap_t overlap = collision_overlap(x, y, dx, dy, radius, bx0, by0, bx1, by1, hit);
+    if (overlap != COLLISION_OVERLAP_NONE) return overlap == COLLISION_OVERLAP_HIT;
+
+    // teste de faixas contra o retângulo expandido pelo raio
+    fix_t t_enter = -FIX_ONE, t_exit = FIX_ONE;
+    fix_t normal_x = 0, normal_y = 0;
+
+    if (dx == 0) {
+        if (x <= bx0 - radius || x >= bx1 + radius) return false;
+    } else {
+        fix_t t0 = collision_plane_time((int64_t)bx0 - radius - x, dx);
+        fix_t t1 = collision_plane_time((int64_t)bx1 + radius - x, dx);
+        fix_t n = -FIX_ONE;
+        if (t0 > t1) { fix_t tmp = t0; t0 = t1; t1 = tmp; n = FIX_ONE; }
+        if (t0 > t_enter) { t_enter = t0; normal_x = n; normal_y = 0; }
+        if (t1 < t_exit) t_exit = t1;
+    }
+
+    if (dy == 0) {
+        if (y <= by0 - radius || y >= by1 + radius) return false;
+    } else {
+        fix_t t0 = collision_plane_time((int64_t)by0 - radius - y, dy);
+        fix_t t1 = collision_plane_time((int64_t)by1 + radius - y, dy);
+        fix_t n = -FIX_ONE;
+        if (t0 > t1) { fix_t tmp = t0; t0 = t1; t1 = tmp; n = FIX_ONE; }
+        if (t0 > t_enter) { t_enter = t0; normal_x = 0; normal_y = n; }
+        if (t1 < t_exit) t_exit = t1;
+    }
+
+    if (t_enter > t_exit || t_enter > FIX_ONE || t_exit < 0) return false;
+
+    // ponto de entrada no retângulo expandido: numa face o contato é esse mesmo,
+    // numa quina o contato real é com o círculo centrado no canto
+    fix_t t = t_enter < 0 ? 0 : t_enter;
+    fix_t px = x + fix_mul(dx, t);
+    fix_t py = y + fix_mul(dy, t);
+
+    bool in_x = px >= bx0 && px <= bx1;
+    bool in_y = py >= by0 && py <= by1;
+    if (t_enter >= 0 && (in_x || in_y)) {
+        hit->toi = t_enter;
+        hit->normal_x = normal_x;
+        hit->normal_y = normal_y;
+        return true;
+    }
+
+    fix_t cx = px < (bx0 >> 1) + (bx1 >> 1) ? bx0 : bx1;
+    fix_t cy = py < (by0 >> 1) + (by1 >> 1) ? by0 : by1;
+    return collision_sweep_corner(x, y, dx, dy, radius, cx, cy, hit);
+}
+
+bool collision_sweep_circle(const occupancy_map_t *walls, fix_t x, fix_t y, fix_t dx, fix_t dy,
+                            fix_t radius, collision_hit_t *hit) {
+    int shift = PHYSICS_FRAC_BITS + walls->cell_shift;
+    fix_t cell_size = FIX_FROM_INT(1 << walls->cell_shift);
+
+    // células que o círculo pode tocar: caixa envolvente do início e do fim do movimento
+    fix_t min_x = (dx < 0 ? x + dx : x) - radius;
+    fix_t max_x = (dx < 0 ? x : x + dx) + radius;
+    fix_t min_y = (dy < 0 ? y + dy : y) - radius;
+    fix_t max_y = (dy < 0 ? y : y + dy) + radius;
+
+    int cx0 = min_x >> shift, cx1 = max_x >> shift;
+    int cy0 = min_y >> shift, cy1 = max_y >> shift;
+
+    bool found = false;
+    hit->toi = FIX_ONE + 1;
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            if (!occupancy_test(walls, cx, cy)) continue;
+
+            fix_t bx0 = cx * cell_size;
+            fix_t by0 = cy * cell_size;
+            collision_hit_t cell_hit;
+            if (collision_sweep_box(x, y, dx, dy, radius, bx0, by0, bx0 + cell_size, by0 + cell_size, &cell_hit) &&
+                cell_hit.toi < hit->toi) {
+                *hit = cell_hit;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+// Remove a componente contra a normal e devolve só a fração "bounce" dela
+void collision_reflect(fix_t *vx, fix_t *vy, fix_t normal_x, fix_t normal_y, fix_t bounce) {
+    fix_t normal_speed = fix_mul(*vx, normal_x) + fix_mul(*vy, normal_y);
+    if (normal_speed >= 0) return;
+
+    fix_t k = normal_speed + fix_mul(normal_speed, bounce);
+    *vx -= fix_mul(k, normal_x);
+    *vy -= fix_mul(k, normal_y);
+}
+
+void collision_move_ball(const occupancy_map_t *walls, physics_ball_t *ball, fix_t radius, fix_t bounce) {
+    // sub-passos de no máximo um raio mantêm a varredura em poucas células
+    fix_t extent = fix_abs(ball->vel_x) > fix_abs(ball->vel_y) ? fix_abs(ball->vel_x) : fix_abs(ball->vel_y);
+    int substeps = 1 + extent / radius;
+    if (substeps > COLLISION_MAX_SUBSTEPS) substeps = COLLISION_MAX_SUBSTEPS;
+
+    for (int step = 0; step < substeps; step++) {
+        fix_t move_x = ball->vel_x / substeps;
+        fix_t move_y = ball->vel_y / substeps;
+
+        for (int iteration = 0; iteration < COLLISION_MAX_ITERATIONS; iteration++) {
+            if (move_x == 0 && move_y == 0) break;
+
+            collision_hit_t hit;
+            if (!collision_sweep_circle(walls, ball->x, ball->y, move_x, move_y, radius, &hit)) {
+                ball->x += move_x;
+                ball->y += move_y;
+                break;
+            }
+
+            // avança até o contato e reflete tanto a velocidade quanto o resto do deslocamento
+            ball->x += fix_mul(move_x, hit.toi);
+            ball->y += fix_mul(move_y, hit.toi);
+
+            fix_t remaining = FIX_ONE - hit.toi;
+            move_x = fix_mul(move_x, remaining);
+            move_y = fix_mul(move_y, remaining);
+
+            collision_reflect(&ball->vel_x, &ball->vel_y, hit.normal_x, hit.normal_y, bounce);
+            collision_reflect(&move_x, &move_y, hit.normal_x, hit.normal_y, bounce);
+        }
+    }
+}
+
+void collision_balls(physics_ball_t *balls, int count, fix_t radius, fix_t bounce, spatial_hash_t *hash) {
+    if (count < 2) return;
+
+    spatial_hash_build(hash, &balls[0].x, &balls[0].y, sizeof(physics_ball_t) / sizeof(fix_t), count);
+    int64_t min_dist = 2 * (int64_t)radius;
+
+    for (int i = 0; i < hash->count; i++) {
+        physics_ball_t *a = &balls[i];
+
+        SPATIAL_HASH_FOR_EACH_NEAR(hash, hash->body_cell[i], j, {
+            if (j <= i) continue;  // cada par uma vez só
+            physics_ball_t *b = &balls[j];
+
+            int64_t dx = b->x - a->x;
+            int64_t dy = b->y - a->y;
+            int64_t dist_sq = dx * dx + dy * dy;
+            if (dist_sq >= min_dist * min_dist) continue;
+
+            // centros coincidentes: separa na horizontal
+            fix_t dist = (fix_t)collision_isqrt64((uint64_t)dist_sq);
+            fix_t normal_x = dist > 0 ? fix_div(dx, dist) : FIX_ONE;
+            fix_t normal_y = dist > 0 ? fix_div(dy, dist) : 0;
+
+            // metade da sobreposição para cada lado
+            fix_t half_overlap = (fix_t)((min_dist - dist) / 2);
+            a->x -= fix_mul(normal_x, half_overlap);
+            a->y -= fix_mul(normal_y, half_overlap);
+            b->x += fix_mul(normal_x, half_overlap);
+            b->y += fix_mul(normal_y, half_overlap);
+
+            // massas iguais: cada bola recebe metade do impulso
+            fix_t approach = fix_mul(b->vel_x - a->vel_x, normal_x) + fix_mul(b->vel_y - a->vel_y, normal_y);
+            if (approach >= 0) continue;
+
+            fix_t impulse = (approach + fix_mul(approach, bounce)) / 2;
+            a->vel_x += fix_mul(impulse, normal_x);
+            a->vel_y += fix_mul(impulse, normal_y);
+            b->vel_x -= fix_mul(impulse, normal_x);
+            b->vel_y -= fix_mul(impulse, normal_y);
+        });
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "physics.h"
+#include "occupancy.h"
+#include "spatial_hash.h"
+
+/*
+* Colisão contínua de um círculo contra as paredes do labirinto
+* Em vez de testar só a célula sob o centro da bola, o movimento do passo é
+* varrido contra cada célula sólida que o círculo pode tocar: o círculo contra
+* um retângulo equivale a um ponto contra o retângulo com cantos arredondados
+* de raio r. O resultado é o instante de impacto (0..1 do deslocamento) e a
+* normal de contato, o que permite refletir a velocidade na direção certa
+* também nas quinas.
+*/
+
+// o deslocamento é dividido em sub-passos de no máximo um raio
+#define COLLISION_MAX_SUBSTEPS   8
+// colisões resolvidas por sub-passo (ex.: bater em duas paredes num canto)
+#define COLLISION_MAX_ITERATIONS 3
+
+typedef struct {
+    fix_t toi;        // fração do deslocamento até o contato (0..FIX_ONE)
+    fix_t normal_x;   // normal unitária apontando da parede para a bola
+    fix_t normal_y;
+} collision_hit_t;
+
+// As paredes vêm de um mapa de ocupação (bit 1 = sólido), por célula ou por pixel;
+// o mapa deve ser criado com outside = true para que a borda também bloqueie
+
+// Varre o círculo de (x, y) até (x + dx, y + dy); retorna true e o primeiro contato se colidir
+bool collision_sweep_circle(const occupancy_map_t *walls, fix_t x, fix_t y, fix_t dx, fix_t dy,
+                            fix_t radius, collision_hit_t *hit);
+
+// Move a bola pela velocidade de um passo, parando no contato e refletindo a velocidade
+void collision_move_ball(const occupancy_map_t *walls, physics_ball_t *ball, fix_t radius, fix_t bounce);
+
+// Separa as bolas (todas de mesmo raio e massa) que se sobrepõem e troca a componente
+// normal das velocidades com o fator de quique. A grade de vizinhança é reconstruída
+// aqui e precisa de células com lado >= 2 * radius
+void collision_balls(physics_ball_t *balls, int count, fix_t radius, fix_t bounce, spatial_hash_t *hash);
+
+// Reflete (vx, vy) na normal unitária se estiver indo contra ela, atenuando pelo quique
+void collision_reflect(fix_t *vx, fix_t *vy, fix_t normal_x, fix_t normal_y, fix_t bounce);
+
+// Raiz quadrada inteira (piso) de um valor de 64 bits
+uint32_t collision_isqrt64(uint64_t value);
+
+#endif
@@ -0,0 +1,15 @@
+#include "crc32.h"
+
+// bit a bit, sem tabela: os registros são pequenos e os resumos não ficam no laço do jogo
+uint32_t crc32(const void *data, uint32_t length) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,10 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3) dos registros na flash (configurações e gravações) e dos
+// resumos do estado da simulação
+uint32_t crc32(const void *data, uint32_t length);
+
+#endif
@@ -1,50 +1,72 @@
 #include "display.h"
+#include "display_transport.h"
 #include "font.h"
-#include "hardware/i2c.h"
+#include "framebuffer_diff.h"
+#include "i2c_bus.h"
 #include "pico/stdlib.h"
+#ifdef SCREEN_MIRROR
+#include "screen_mirror.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
 
 // static void i2c_init_custom();
 // static void ssd1306_send_command(uint8_t command);
 
-// essa é uma função estatica para inicializar a comunicação i2c
-static void i2c_init_custom() {
-    // esta usando 400khz pq o display suporta comunicação standart e fast
-    // a standart tem velocidade máxima de 100khz
-    // a fast tem velocidade máxima de 400khz
-    // no caso, estamos usando a fast
-    i2c_init(I2C_PORT, 400 * 1000);
-    gpio_set_function(SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(SCL_PIN, GPIO_FUNC_I2C);
-
-    // é importante ativar o pull up ja que o sda e o scl são open-drain
-    // os dispositivos conseguem puxar o fio para gnd
-    // eles não conseguem forçar ele para o VCC
-    // dessa forma, o pull up faz esse papel, deixando em nível lógico alto
-    gpio_pull_up(SDA_PIN);
-    gpio_pull_up(SCL_PIN);
+// escritas que o display não confirmou (sem ACK no barramento ou sem terminar a tempo)
+static i2c_bus_stats_t display_bus;
+
+// cópia do que está na memória do display; só vale depois da primeira atualização
+// (os transportes por DMA mandam os dados dos trechos direto daqui)
+static uint8_t panel[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8] __attribute__((aligned(4)));
+static bool panel_valid = false;
+
+// comandos que posicionam um trecho: a janela de colunas e página no SSD1306, ou a
+// página e a coluna inicial no SH1106 (que não tem janela)
+#ifdef DISPLAY_SH1106
+#define DISPLAY_WINDOW_SIZE 3
+#else
+#define DISPLAY_WINDOW_SIZE 6
+#endif
+
+// custo fixo de um trecho no barramento: os comandos da janela e o que o transporte
+// gasta para mandar comandos e dados; intervalos menores que isso vão junto
+#define DISPLAY_SPAN_OVERHEAD (DISPLAY_WINDOW_SIZE + DISPLAY_TRANSPORT_OVERHEAD)
+
+// clock de fato em uso no barramento
+static uint32_t display_baudrate = 0;
+
+#if defined(DISPLAY_SPI)
+// degraus do teste de clock; sem ACK no SPI nada falha, então o teste sobe direto até o
+// teto, e os degraus acima de 10 MHz só valem com DISPLAY_SPI_MAX_BAUDRATE maior (display.h)
+static const uint32_t display_probe_steps[] = {10 * 1000 * 1000, 16 * 1000 * 1000, 20 * 1000 * 1000,
+                                               25 * 1000 * 1000};
+#elif defined(DISPLAY_PIO_I2C)
+// degraus do teste de clock; o PIO passa do Fast-mode Plus (o limite fica nos pull-ups e no display)
+static const uint32_t display_probe_steps[] = {400 * 1000, 600 * 1000, 800 * 1000, 1000 * 1000,
+                                               1500 * 1000, 2000 * 1000};
+#else
+// degraus do teste de clock, do Fast-mode ao Fast-mode Plus
+static const uint32_t display_probe_steps[] = {400 * 1000, 600 * 1000, 800 * 1000, 1000 * 1000};
+#endif
+
+// telas inteiras enviadas em cada degrau do teste
+#define DISPLAY_PROBE_FRAMES 4
+
+// envia um comando para o controlador pelo transporte escolhido (display_transport.h)
+static void ssd1306_send_command(uint8_t command) {
+    display_transport_command(&command, 1);
 }
 
-// envia um comando para o display ssd1306 via i2c
-static void ssd1306_send_command(uint8_t command) {
-    // é um array de 2 byts para enviar pela i2c
-    // - 0x00 é um prefixo de comando, indica que o proximo byte é um comando
-    // - command é o comando real que queremos enviar para o display
-    uint8_t data[] = {0x00, command};
-
-    // essa função recebe uma sequencia de dados
-    // - I2C_PORT é qual a porta i2c do rp2040 está sendo usada
-    // - 0x3C é o endereço i2c do ssd1306
-    // - data é os bytes que queremos enviar
-    // - false envair stop condition no final, encerrando a transmissão
-    i2c_write_blocking(I2C_PORT, 0x3C, data, sizeof(data), false);
+// espera o envio anterior; se algo dele não chegou, a memória do display é desconhecida
+static void display_wait(void) {
+    if (!display_transport_wait()) panel_valid = false;
 }
-// inicializa tudo do display
-void display_init(display *display) {
-    if (display->initialized) return;
 
-    i2c_init_custom();
+// sequência de configuração do controlador (também usada para reconfigurar depois de um erro)
+static void ssd1306_configure(void) {
+    display_wait();
+
     // garante que o display esteja desligado antes de configurar
     ssd1306_send_command(0xAE); // display OFF
 
@@ -63,6 +85,13 @@ void display_init(display *display) {
     // começa a desenhar a partir da linha 0
     ssd1306_send_command(0x40); // Set display Start Line para 0
 
+#ifdef DISPLAY_SH1106
+    // o SH1106 gera a tensão do oled com um conversor DC-DC, ligado por outro comando
+    ssd1306_send_command(0xAD); // DC-DC Control Mode Set
+    ssd1306_send_command(0x8B); // Ligado
+
+    // ele só escreve no modo de página: não há modo horizontal para escolher
+#else
     // liga a bomba de carga interna, necessário para gerar tensão do oled
     ssd1306_send_command(0x8D); // Ativa Charge Pump
     ssd1306_send_command(0x14); // Habilita
@@ -70,6 +99,7 @@ void display_init(display *display) {
     // escreve horizontalmente na ram do display
     ssd1306_send_command(0x20); // Define modo de endereçamento
     ssd1306_send_command(0x00); // Modo horizontal
+#endif
 
     // inverte a ordem das colunas
     ssd1306_send_command(0xA1); // Segment Re-map (coluna 127 mapeada para SEG0)
@@ -102,33 +132,135 @@ void display_init(display *display) {
     // finalmente liga o display depois da configuração
     ssd1306_send_command(0xAF); // display ON
 
+    display_transport_flush();
+    display_wait();
+}
+
+// inicializa tudo do display
+void display_init(display *display) {
+    if (display->initialized) return;
+
+    display_baudrate = display_transport_init(display->baudrate ? display->baudrate : DISPLAY_BAUDRATE, &display_bus);
+    ssd1306_configure();
+
     //zera o buffer que representa a tela inteira
     memset(display->buffer, 0, sizeof(display->buffer));
 
+    // a memória do display depois de ligar é lixo: a primeira atualização vai inteira
+    panel_valid = false;
+
     // marca como inicializado
     display->initialized = true;
 }
 
-// envia o conteúdo do display->buffer inteiro pro display, página por página
-// cada página == 128 bytes
+// envia um trecho de uma página (já copiado para panel): primeiro a posição, depois os dados
+static bool ssd1306_send_span(const framebuffer_span_t *span) {
+#ifdef DISPLAY_SH1106
+    // página e coluna inicial (nibble baixo e alto); a coluna anda sozinha a cada byte
+    uint8_t column = span->start + SH1106_COLUMN_OFFSET;
+    uint8_t window[] = {0xB0 | span->page, 0x00 | (column & 0x0F), 0x10 | (column >> 4)};
+#else
+    // a janela de colunas e de página; no modo horizontal o ponteiro anda dentro dela sozinho
+    uint8_t window[] = {0x21, span->start, span->end, 0x22, span->page, span->page};
+#endif
+
+    return display_transport_command(window, sizeof(window)) &&
+           display_transport_data(&panel[span->page * DISPLAY_WIDTH + span->start], framebuffer_span_length(span));
+}
+
+// depois de falhas seguidas: solta o barramento, reinicia o transporte e reconfigura o
+// display (ele pode ter sido resetado por uma queda de tensão); a tela vai inteira em seguida
+static void display_recover(void) {
+    display_transport_recover();
+    ssd1306_configure();
+    panel_valid = false;
+    i2c_bus_recovered(&display_bus);
+}
+
+// envia pro display só o que mudou desde a última atualização
+// cada página == 128 bytes, e cada trecho é um pedaço de uma página
 void display_update(display *display) {
-    // como cada page tem 128 colunas, e cada coluna é um inteiro de 8 bytes
-    for (uint8_t page = 0; page < 8; page++) {
+    display_wait();
+    if (i2c_bus_needs_recovery(&display_bus)) display_recover();
+
+    framebuffer_span_t spans[FRAMEBUFFER_MAX_SPANS];
+    int count = panel_valid ? framebuffer_diff(display->buffer, panel, DISPLAY_SPAN_OVERHEAD, spans)
+                            : framebuffer_full(spans);
+
+    panel_valid = true;
+    for (int i = 0; i < count; i++) {
+        framebuffer_commit(panel, display->buffer, &spans[i]);
+        if (!ssd1306_send_span(&spans[i])) {
+            // sem saber o que chegou, a próxima atualização vai inteira; o resto deste
+            // quadro nem é tentado (com o barramento ruim só gastaria os tempos limite)
+            panel_valid = false;
+            break;
+        }
+    }
+
+    // nos transportes por DMA o envio segue enquanto o jogo calcula o próximo quadro;
+    // uma falha aparece na espera do começo da próxima atualização
+    display_transport_flush();
+
+#ifdef SCREEN_MIRROR
+    // a mesma imagem vai para o PC (só o que mudou, sem esperar pelo USB)
+    screen_mirror_frame(display->buffer);
+#endif
+}
+
+void display_flush(void) {
+    display_wait();
+}
+
+uint32_t display_error_count(void) {
+    return display_bus.errors;
+}
 
-        ssd1306_send_command(0xB0 + page);
-        ssd1306_send_command(0x00);
-        ssd1306_send_command(0x10);
+i2c_bus_stats_t display_i2c_stats(void) {
+    return display_bus;
+}
 
-        uint8_t data[129];
-        // o prefixo 0x40 indica ao diplay que vem dados, e não comandos
-        data[0] = 0x40;
+void display_invalidate(void) {
+    panel_valid = false;
+}
 
-        // coloca os dados da page imediatamente depois do local onde ta armazenado o comando
-        memcpy(&data[1], &display->buffer[page * DISPLAY_WIDTH], DISPLAY_WIDTH);
+uint32_t display_set_baudrate(display *display, uint32_t baudrate) {
+    display->baudrate = baudrate;
+    display_wait();
+    display_baudrate = display_transport_set_baudrate(baudrate);
+    return display_baudrate;
+}
+
+uint32_t display_get_baudrate(void) {
+    return display_baudrate;
+}
 
-        // escrevendo no display
-        i2c_write_blocking(I2C_PORT, 0x3C, data, sizeof(data), false);
+// o display não deixa ler a memória pelo I2C: a verificação de cada degrau é pelo
+// ACK de todos os bytes de algumas telas inteiras (um erro volta ao degrau anterior)
+uint32_t display_probe_baudrate(display *display, uint32_t max_baudrate) {
+    uint32_t good = display->baudrate ? display->baudrate : DISPLAY_BAUDRATE;
+
+    for (size_t i = 0; i < sizeof(display_probe_steps) / sizeof(display_probe_steps[0]); i++) {
+        uint32_t step = display_probe_steps[i];
+        if (step <= good) continue;
+        if (step > max_baudrate) break;
+
+        display_set_baudrate(display, step);
+        uint32_t errors = display_bus.errors;
+        for (int frame = 0; frame < DISPLAY_PROBE_FRAMES && display_bus.errors == errors; frame++) {
+            display_invalidate();
+            display_update(display);
+            display_wait();
+        }
+        if (display_bus.errors != errors) break;
+        good = step;
     }
+
+    // o que falhou pode ter deixado a tela pela metade
+    display_set_baudrate(display, good);
+    display_invalidate();
+    display_update(display);
+    return display_baudrate;
 }
 
 // limpa o buffer do display
@@ -313,14 +445,27 @@ void display_shutdown(display *display) {
     display_clear(display);
     display_update(display);
 
+    display_wait();
     ssd1306_send_command(0xAE); // display OFF
 
+#ifdef DISPLAY_SH1106
+    ssd1306_send_command(0xAD); // DC-DC
+    ssd1306_send_command(0x8A); // desativa
+#else
     ssd1306_send_command(0x8D); // charge Pump
     ssd1306_send_command(0x10); // desativa
-
-    i2c_deinit(I2C_PORT);
+#endif
+    display_transport_flush();
+    display_wait();
+
+    display_transport_deinit();
+#ifdef DISPLAY_SPI
+    gpio_set_function(DISPLAY_SCK_PIN, GPIO_FUNC_NULL);
+    gpio_set_function(DISPLAY_MOSI_PIN, GPIO_FUNC_NULL);
+#else
     gpio_set_function(SDA_PIN, GPIO_FUNC_NULL);
     gpio_set_function(SCL_PIN, GPIO_FUNC_NULL);
+#endif
 
     display->initialized = false;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "i2c_bus.h"
 
 /*
 * Como funciona a troca de dados
@@ -16,14 +17,65 @@
 
 #define I2C_PORT i2c1
 
+// clock do I2C: o SSD1306 é especificado até 400 kHz (Fast-mode), mas a maioria dos
+// módulos aguenta 1 MHz (Fast-mode Plus, suportado pelo RP2040); acima de 400 kHz os
+// pull-ups internos são fracos demais e é preciso resistores externos (2.2k ou menos)
+#ifndef DISPLAY_I2C_BAUDRATE
+#define DISPLAY_I2C_BAUDRATE (400 * 1000)
+#endif
+// com -DDISPLAY_PIO_I2C o barramento é gerado pelo PIO e alimentado por DMA
+// (ssd1306_pio.h): a atualização retorna sem esperar o envio e o clock passa de 1 MHz
+// (o transporte é escolhido na compilação, display_transport.h)
+#ifndef DISPLAY_I2C_MAX_BAUDRATE
+#ifdef DISPLAY_PIO_I2C
+#define DISPLAY_I2C_MAX_BAUDRATE (2000 * 1000)
+#else
+#define DISPLAY_I2C_MAX_BAUDRATE (1000 * 1000)
+#endif
+#endif
+
+// módulos SPI (-DDISPLAY_SPI): SCK e MOSI no spi0, mais os pinos de seleção,
+// comando/dado e reset; o SSD1306 é especificado até 10 MHz, e costuma ir além
+#define DISPLAY_SCK_PIN  18
+#define DISPLAY_MOSI_PIN 19
+#define DISPLAY_CS_PIN   17
+#define DISPLAY_DC_PIN   20
+#define DISPLAY_RST_PIN  16
+
+#define DISPLAY_SPI_PORT spi0
+
+#ifndef DISPLAY_SPI_BAUDRATE
+#define DISPLAY_SPI_BAUDRATE (10 * 1000 * 1000)
+#endif
+// sem ACK o teste de clock não tem como ver um erro no SPI: o teto fica no limite do
+// datasheet, e passar dele é escolha de quem compila (ex.: -DDISPLAY_SPI_MAX_BAUDRATE=20000000)
+#ifndef DISPLAY_SPI_MAX_BAUDRATE
+#define DISPLAY_SPI_MAX_BAUDRATE (10 * 1000 * 1000)
+#endif
+
+// clock padrão e teto do teste de clock do transporte escolhido
+#ifdef DISPLAY_SPI
+#define DISPLAY_BAUDRATE DISPLAY_SPI_BAUDRATE
+#define DISPLAY_MAX_BAUDRATE DISPLAY_SPI_MAX_BAUDRATE
+#else
+#define DISPLAY_BAUDRATE DISPLAY_I2C_BAUDRATE
+#define DISPLAY_MAX_BAUDRATE DISPLAY_I2C_MAX_BAUDRATE
+#endif
+
+// -DDISPLAY_SH1106 troca o controlador pelo SH1106 (módulos de 1.3"): a memória dele
+// tem 132 colunas, com a tela começando na coluna 2, e só o modo de página
+#define SH1106_COLUMN_OFFSET 2
+
 
 #define DISPLAY_WIDTH 128
 #define DISPLAY_HEIGHT 64
 
 
 typedef struct {
-    uint8_t buffer[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8];
+    // alinhado para a comparação de 4 em 4 bytes (framebuffer_diff.h)
+    uint8_t buffer[DISPLAY_WIDTH * DISPLAY_HEIGHT / 8] __attribute__((aligned(4)));
     bool initialized;
+    uint32_t baudrate;   // clock do barramento pedido; 0 usa DISPLAY_BAUDRATE
 } display;
 
 void display_init(display *display);
@@ -31,6 +83,25 @@ void display_update(display *display);
 void display_clear(display *display);
 void display_shutdown(display *display);
 
+// quantas escritas no display falharam desde o início, e os detalhes (tempos
+// esgotados e recuperações do barramento)
+uint32_t display_error_count(void);
+i2c_bus_stats_t display_i2c_stats(void);
+
+// Troca o clock do barramento; retorna o clock de fato obtido pelos divisores do RP2040
+uint32_t display_set_baudrate(display *display, uint32_t baudrate);
+uint32_t display_get_baudrate(void);
+
+// Sobe o clock em degraus até max_baudrate enquanto telas inteiras passarem sem
+// erro; fica no último degrau que funcionou e o retorna
+uint32_t display_probe_baudrate(display *display, uint32_t max_baudrate);
+
+// Faz a próxima atualização mandar a tela inteira
+void display_invalidate(void);
+
+// Espera o fim do envio da última atualização (só o PIO e o SPI enviam em segundo plano)
+void display_flush(void);
+
 void display_draw_pixel(int x, int y, bool on, display *display);
 void display_draw_line(int x0, int y0, int x1, int y1, bool on, display *display);
 void display_draw_char(int x, int y, char c, bool on, display *display);
@@ -0,0 +1,82 @@
+#if !defined(DISPLAY_PIO_I2C) && !defined(DISPLAY_SPI)
+#include "display_transport.h"
+#include "display.h"
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// transporte padrão: o periférico I2C do RP2040, uma transação por chamada
+
+// endereço i2c do ssd1306 (e do sh1106)
+#define DISPLAY_I2C_ADDRESS 0x3C
+
+static i2c_bus_stats_t *display_i2c_bus;
+static uint32_t display_i2c_baudrate;
+
+uint32_t display_transport_init(uint32_t baudrate, i2c_bus_stats_t *stats) {
+    display_i2c_bus = stats;
+
+    // o display suporta comunicação standart e fast (e quase sempre fast plus)
+    // a standart tem velocidade máxima de 100khz
+    // a fast tem velocidade máxima de 400khz, o padrão (DISPLAY_I2C_BAUDRATE)
+    // a fast plus chega a 1mhz
+    display_i2c_baudrate = i2c_init(I2C_PORT, baudrate);
+    gpio_set_function(SDA_PIN, GPIO_FUNC_I2C);
+    gpio_set_function(SCL_PIN, GPIO_FUNC_I2C);
+
+    // é importante ativar o pull up ja que o sda e o scl são open-drain
+    // os dispositivos conseguem puxar o fio para gnd
+    // eles não conseguem forçar ele para o VCC
+    // dessa forma, o pull up faz esse papel, deixando em nível lógico alto
+    gpio_pull_up(SDA_PIN);
+    gpio_pull_up(SCL_PIN);
+    return display_i2c_baudrate;
+}
+
+void display_transport_deinit(void) {
+    i2c_deinit(I2C_PORT);
+}
+
+uint32_t display_transport_set_baudrate(uint32_t baudrate) {
+    display_i2c_baudrate = i2c_set_baudrate(I2C_PORT, baudrate);
+    return display_i2c_baudrate;
+}
+
+// a transação começa pelo byte de controle:
+// - 0x00 indica que os próximos bytes são comandos
+// - 0x40 indica que vem dados, e não comandos
+static bool display_i2c_write(uint8_t control, const uint8_t *src, size_t length) {
+    uint8_t data[DISPLAY_WIDTH + 1];
+    if (length > DISPLAY_WIDTH) return false;
+    data[0] = control;
+    memcpy(&data[1], src, length);
+
+    // com tempo limite, para um barramento travado não prender o programa;
+    // false envia a stop condition no final, encerrando a transmissão
+    return i2c_bus_write(I2C_PORT, DISPLAY_I2C_ADDRESS, data, length + 1, false, display_i2c_baudrate,
+                         display_i2c_bus);
+}
+
+bool display_transport_command(const uint8_t *commands, size_t length) {
+    return display_i2c_write(0x00, commands, length);
+}
+
+bool display_transport_data(const uint8_t *data, size_t length) {
+    return display_i2c_write(0x40, data, length);
+}
+
+// as escritas pelo periférico já terminam dentro de cada chamada
+void display_transport_flush(void) {
+}
+
+bool display_transport_wait(void) {
+    return true;
+}
+
+void display_transport_recover(void) {
+    i2c_deinit(I2C_PORT);
+    i2c_bus_clear(SDA_PIN, SCL_PIN);
+    display_transport_init(display_i2c_baudrate, display_i2c_bus);
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifdef DISPLAY_PIO_I2C
+#include "display_transport.h"
+#include "display.h"
+#include "framebuffer_diff.h"
+#include "ssd1306_pio.h"
+
+// transporte pelo PIO: os comandos e os dados de uma atualização viram um fluxo
+// de transações (ssd1306_pio.h), que o DMA manda enquanto o jogo calcula o próximo quadro
+
+#define DISPLAY_I2C_ADDRESS 0x3C
+
+// no pior caso todos os trechos, cada um com uma janela de até 6 comandos, e a tela
+// inteira de dados; a configuração (uma transação por comando) cabe com folga
+#define DISPLAY_STREAM_SIZE \
+    (FRAMEBUFFER_MAX_SPANS * (2 * SSD1306_PIO_TRANSACTION_OVERHEAD + 6) + FRAMEBUFFER_SIZE)
+
+static uint8_t display_stream[DISPLAY_STREAM_SIZE];
+static size_t display_stream_length = 0;
+static i2c_bus_stats_t *display_pio_bus;
+
+uint32_t display_transport_init(uint32_t baudrate, i2c_bus_stats_t *stats) {
+    display_pio_bus = stats;
+    display_stream_length = 0;
+    return ssd1306_pio_init(SDA_PIN, SCL_PIN, baudrate);
+}
+
+void display_transport_deinit(void) {
+    ssd1306_pio_deinit();
+}
+
+uint32_t display_transport_set_baudrate(uint32_t baudrate) {
+    return ssd1306_pio_set_baudrate(baudrate);
+}
+
+static bool display_pio_append(uint8_t control, const uint8_t *src, size_t length) {
+    if (length > SSD1306_PIO_MAX_TRANSACTION ||
+        display_stream_length + length + SSD1306_PIO_TRANSACTION_OVERHEAD > DISPLAY_STREAM_SIZE) {
+        return false;
+    }
+    display_stream_length += ssd1306_pio_transaction(&display_stream[display_stream_length], DISPLAY_I2C_ADDRESS,
+                                                     control, src, length);
+    return true;
+}
+
+bool display_transport_command(const uint8_t *commands, size_t length) {
+    return display_pio_append(0x00, commands, length);
+}
+
+bool display_transport_data(const uint8_t *data, size_t length) {
+    return display_pio_append(0x40, data, length);
+}
+
+// o fluxo só volta a ser escrito depois de display_transport_wait
+void display_transport_flush(void) {
+    ssd1306_pio_send(display_stream, display_stream_length);
+    display_stream_length = 0;
+}
+
+bool display_transport_wait(void) {
+    return ssd1306_pio_wait(display_pio_bus);
+}
+
+void display_transport_recover(void) {
+    display_stream_length = 0;
+    ssd1306_pio_reset();
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifdef DISPLAY_SPI
+#include "display_transport.h"
+#include "display.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/spi.h"
+#include "pico/stdlib.h"
+
+// transporte SPI (4 fios): o pino D/C diz se o byte é comando (0) ou dado (1), então
+// os comandos vão pelo processador e os dados de cada trecho por DMA; o DMA de um
+// trecho corre enquanto o próximo é preparado, e o último enquanto o jogo segue
+
+static int display_spi_dma = -1;
+static bool display_spi_pending = false;
+
+// tempos do pulso de reset (o datasheet pede ao menos 3 us em nível baixo)
+#define DISPLAY_SPI_RESET_US 1000
+
+static void display_spi_reset(void) {
+    gpio_put(DISPLAY_RST_PIN, 0);
+    sleep_us(DISPLAY_SPI_RESET_US);
+    gpio_put(DISPLAY_RST_PIN, 1);
+    sleep_us(DISPLAY_SPI_RESET_US);
+}
+
+// o D/C só pode mudar depois que o último bit saiu, e não só quando o DMA acabou
+static void display_spi_finish(void) {
+    if (!display_spi_pending) return;
+    dma_channel_wait_for_finish_blocking(display_spi_dma);
+    while (spi_is_busy(DISPLAY_SPI_PORT)) tight_loop_contents();
+
+    // só se escreve: o que chegou na recepção durante o DMA é descartado
+    while (spi_is_readable(DISPLAY_SPI_PORT)) (void)spi_get_hw(DISPLAY_SPI_PORT)->dr;
+    spi_get_hw(DISPLAY_SPI_PORT)->icr = SPI_SSPICR_RORIC_BITS;
+    display_spi_pending = false;
+}
+
+uint32_t display_transport_init(uint32_t baudrate, i2c_bus_stats_t *stats) {
+    // modo 0, MSB primeiro: o controlador lê o bit na subida do clock
+    uint32_t actual = spi_init(DISPLAY_SPI_PORT, baudrate);
+    spi_set_format(DISPLAY_SPI_PORT, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    gpio_set_function(DISPLAY_SCK_PIN, GPIO_FUNC_SPI);
+    gpio_set_function(DISPLAY_MOSI_PIN, GPIO_FUNC_SPI);
+
+    gpio_init(DISPLAY_DC_PIN);
+    gpio_set_dir(DISPLAY_DC_PIN, GPIO_OUT);
+    gpio_init(DISPLAY_RST_PIN);
+    gpio_set_dir(DISPLAY_RST_PIN, GPIO_OUT);
+    // o display é o único no barramento: fica selecionado o tempo todo
+    gpio_init(DISPLAY_CS_PIN);
+    gpio_set_dir(DISPLAY_CS_PIN, GPIO_OUT);
+    gpio_put(DISPLAY_CS_PIN, 0);
+
+    display_spi_reset();
+
+    // sem canal de DMA livre os dados vão pelo processador
+    display_spi_dma = dma_claim_unused_channel(false);
+    if (display_spi_dma >= 0) {
+        dma_channel_config config = dma_channel_get_default_config(display_spi_dma);
+        channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+        channel_config_set_read_increment(&config, true);
+        channel_config_set_write_increment(&config, false);
+        channel_config_set_dreq(&config, spi_get_dreq(DISPLAY_SPI_PORT, true));
+        dma_channel_configure(display_spi_dma, &config, &spi_get_hw(DISPLAY_SPI_PORT)->dr, NULL, 0, false);
+    }
+    display_spi_pending = false;
+    return actual;
+}
+
+void display_transport_deinit(void) {
+    display_spi_finish();
+    if (display_spi_dma >= 0) dma_channel_unclaim(display_spi_dma);
+    display_spi_dma = -1;
+    spi_deinit(DISPLAY_SPI_PORT);
+    gpio_put(DISPLAY_CS_PIN, 1);
+}
+
+uint32_t display_transport_set_baudrate(uint32_t baudrate) {
+    display_spi_finish();
+    return spi_set_baudrate(DISPLAY_SPI_PORT, baudrate);
+}
+
+bool display_transport_command(const uint8_t *commands, size_t length) {
+    display_spi_finish();
+    gpio_put(DISPLAY_DC_PIN, 0);
+    spi_write_blocking(DISPLAY_SPI_PORT, commands, length);
+    return true;
+}
+
+bool display_transport_data(const uint8_t *data, size_t length) {
+    display_spi_finish();
+    gpio_put(DISPLAY_DC_PIN, 1);
+    if (display_spi_dma < 0) {
+        spi_write_blocking(DISPLAY_SPI_PORT, data, length);
+        return true;
+    }
+    dma_channel_transfer_from_buffer_now(display_spi_dma, data, length);
+    display_spi_pending = true;
+    return true;
+}
+
+// cada trecho já começa a sair em display_transport_data
+void display_transport_flush(void) {
+}
+
+bool display_transport_wait(void) {
+    display_spi_finish();
+    return true;
+}
+
+// sem ACK não há falha para detectar; se pedirem, o reset por pino zera o controlador
+void display_transport_recover(void) {
+    display_spi_finish();
+    display_spi_reset();
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef DISPLAY_TRANSPORT_H
+#define DISPLAY_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "i2c_bus.h"
+
+/*
+* Transporte do display: como os comandos e os dados chegam no controlador
+* display.c cuida do framebuffer, dos trechos alterados e dos comandos do
+* SSD1306/SH1106; o caminho até ele é escolhido na compilação, e só um é
+* compilado (as chamadas são diretas, uma por trecho, sem custo por byte):
+*   padrão            I2C do RP2040, bloqueante (display_i2c.c)
+*   -DDISPLAY_PIO_I2C I2C gerado pelo PIO e alimentado por DMA (display_pio.c)
+*   -DDISPLAY_SPI     SPI a 10 MHz, dados por DMA (display_spi.c)
+*
+* Os transportes por DMA só começam o envio: os dados precisam continuar
+* iguais até display_transport_wait, que display.c chama antes de mexer no
+* barramento de novo (comandos, trechos, clock ou desligar).
+*/
+
+#if defined(DISPLAY_PIO_I2C) && defined(DISPLAY_SPI)
+#error "escolha um transporte só: DISPLAY_PIO_I2C ou DISPLAY_SPI"
+#endif
+
+// custo fixo de um par comandos + dados no barramento, além dos próprios comandos
+#if defined(DISPLAY_SPI)
+#define DISPLAY_TRANSPORT_OVERHEAD 4     // troca do D/C e início do DMA, o preço de uns poucos bytes
+#elif defined(DISPLAY_PIO_I2C)
+#define DISPLAY_TRANSPORT_OVERHEAD 6     // contador, endereço e controle das duas transações
+#else
+#define DISPLAY_TRANSPORT_OVERHEAD 4     // endereço e controle das duas transações
+#endif
+
+// Liga o barramento; retorna o clock de fato obtido (0 se faltou algum recurso).
+// Os erros (sem ACK ou tempo esgotado) são contados em stats; o SPI não tem ACK
+uint32_t display_transport_init(uint32_t baudrate, i2c_bus_stats_t *stats);
+void display_transport_deinit(void);
+uint32_t display_transport_set_baudrate(uint32_t baudrate);
+
+// Comandos para o controlador, e dados para a memória a partir da posição que eles
+// definiram; retornam false se já se sabe que não chegaram
+bool display_transport_command(const uint8_t *commands, size_t length);
+bool display_transport_data(const uint8_t *data, size_t length);
+
+// Começa a mandar o que foi acumulado (só o PIO acumula; nos outros não faz nada)
+void display_transport_flush(void);
+
+// Espera o fim do envio em andamento; retorna false se algo dele não chegou
+bool display_transport_wait(void);
+
+// Depois de falhas seguidas: solta o barramento e reinicia o transporte
+// (display.c reconfigura o controlador em seguida)
+void display_transport_recover(void);
+
+#endif
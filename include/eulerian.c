@@ -0,0 +1,331 @@
+#include "eulerian.h"
+#include "parallel.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+#define EULERIAN_HALF (FIX_ONE / 2)
+
+_Static_assert(EULERIAN_CELL_SHIFT == 2, "o desenho por nibbles supõe células de 4x4 pixels");
+
+// 1/n para os vizinhos livres de uma célula (n = 1..4)
+static const fix_t eulerian_reciprocal[5] = {
+    0, FIX_ONE, FIX_ONE / 2, FIX_ONE / 3, FIX_ONE / 4
+};
+
+// matriz de Bayer 4x4: o pixel acende quando o nível passa do limiar
+static const uint8_t eulerian_bayer[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5}
+};
+
+// nibble de cada coluna da célula para cada nível de 0 a 16
+static uint8_t eulerian_dither[17][4];
+
+static inline fix_t eulerian_clamp(fix_t value, fix_t limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+static inline bool eulerian_is_solid(const eulerian_t *grid, int x, int y) {
+    if (x < 0 || y < 0 || x >= EULERIAN_WIDTH || y >= EULERIAN_HEIGHT) return true;
+    return grid->solid[y][x];
+}
+
+static inline bool eulerian_is_fluid(const eulerian_t *grid, int x, int y, uint16_t level) {
+    return !eulerian_is_solid(grid, x, y) && grid->fill[y][x] >= level;
+}
+
+// Interpola bilinearmente um campo w x h na posição (gx, gy) dada em amostras
+static fix_t eulerian_sample(const fix_t *field, int w, int h, fix_t gx, fix_t gy) {
+    fix_t max_x = FIX_FROM_INT(w - 1), max_y = FIX_FROM_INT(h - 1);
+    if (gx < 0) gx = 0;
+    if (gx > max_x) gx = max_x;
+    if (gy < 0) gy = 0;
+    if (gy > max_y) gy = max_y;
+
+    int ix = gx >> PHYSICS_FRAC_BITS, iy = gy >> PHYSICS_FRAC_BITS;
+    if (ix > w - 2) ix = w - 2;
+    if (iy > h - 2) iy = h - 2;
+    fix_t fx = gx - FIX_FROM_INT(ix), fy = gy - FIX_FROM_INT(iy);
+
+    const fix_t *row = &field[iy * w + ix];
+    fix_t top = row[0] + fix_mul(row[1] - row[0], fx);
+    fix_t bottom = row[w] + fix_mul(row[w + 1] - row[w], fx);
+    return top + fix_mul(bottom - top, fy);
+}
+
+// Mesma interpolação para o fill (Q.12 em 16 bits)
+static uint16_t eulerian_sample_fill(const eulerian_t *grid, fix_t gx, fix_t gy) {
+    fix_t max_x = FIX_FROM_INT(EULERIAN_WIDTH - 1), max_y = FIX_FROM_INT(EULERIAN_HEIGHT - 1);
+    if (gx < 0) gx = 0;
+    if (gx > max_x) gx = max_x;
+    if (gy < 0) gy = 0;
+    if (gy > max_y) gy = max_y;
+
+    int ix = gx >> PHYSICS_FRAC_BITS, iy = gy >> PHYSICS_FRAC_BITS;
+    if (ix > EULERIAN_WIDTH - 2) ix = EULERIAN_WIDTH - 2;
+    if (iy > EULERIAN_HEIGHT - 2) iy = EULERIAN_HEIGHT - 2;
+    fix_t fx = gx - FIX_FROM_INT(ix), fy = gy - FIX_FROM_INT(iy);
+
+    int32_t f00 = grid->fill[iy][ix], f10 = grid->fill[iy][ix + 1];
+    int32_t f01 = grid->fill[iy + 1][ix], f11 = grid->fill[iy + 1][ix + 1];
+    int32_t top = f00 + (int32_t)(((int64_t)(f10 - f00) * fx) >> PHYSICS_FRAC_BITS);
+    int32_t bottom = f01 + (int32_t)(((int64_t)(f11 - f01) * fx) >> PHYSICS_FRAC_BITS);
+    return (uint16_t)(top + (int32_t)(((int64_t)(bottom - top) * fy) >> PHYSICS_FRAC_BITS));
+}
+
+// u nas faces verticais fica em (i, j + 0.5); v nas horizontais em (i + 0.5, j)
+static inline fix_t eulerian_velocity_u(const eulerian_t *grid, fix_t x, fix_t y) {
+    return eulerian_sample(&grid->u[0][0], EULERIAN_WIDTH + 1, EULERIAN_HEIGHT, x, y - EULERIAN_HALF);
+}
+
+static inline fix_t eulerian_velocity_v(const eulerian_t *grid, fix_t x, fix_t y) {
+    return eulerian_sample(&grid->v[0][0], EULERIAN_WIDTH, EULERIAN_HEIGHT + 1, x - EULERIAN_HALF, y);
+}
+
+static inline bool eulerian_u_blocked(const eulerian_t *grid, int i, int j) {
+    return eulerian_is_solid(grid, i - 1, j) || eulerian_is_solid(grid, i, j);
+}
+
+static inline bool eulerian_v_blocked(const eulerian_t *grid, int i, int j) {
+    return eulerian_is_solid(grid, i, j - 1) || eulerian_is_solid(grid, i, j);
+}
+
+void eulerian_config_default(eulerian_config_t *config) {
+    config->gravity = FIX_FROM_FLOAT(EULERIAN_GRAVITY);
+    config->max_speed = FIX_FROM_FLOAT(EULERIAN_MAX_SPEED);
+    config->overrelax = FIX_FROM_FLOAT(EULERIAN_OVERRELAX);
+    config->fill_level = (uint16_t)(EULERIAN_FILL_LEVEL * EULERIAN_FILL_ONE);
+}
+
+void eulerian_init(eulerian_t *grid, const occupancy_map_t *walls) {
+    memset(grid, 0, sizeof(*grid));
+    eulerian_config_default(&grid->config);
+
+    for (int level = 0; level <= 16; level++) {
+        for (int column = 0; column < 4; column++) {
+            uint8_t nibble = 0;
+            for (int row = 0; row < 4; row++) {
+                if (eulerian_bayer[row][column] < level) nibble |= 1u << row;
+            }
+            eulerian_dither[level][column] = nibble;
+        }
+    }
+
+    // parede se o centro da célula cai numa célula sólida do mapa
+    int free_cells = 0;
+    for (int y = 0; y < EULERIAN_HEIGHT; y++) {
+        for (int x = 0; x < EULERIAN_WIDTH; x++) {
+            int px = (x << EULERIAN_CELL_SHIFT) + 2;
+            int py = (y << EULERIAN_CELL_SHIFT) + 2;
+            grid->solid[y][x] = occupancy_test(walls, px >> walls->cell_shift, py >> walls->cell_shift);
+            if (!grid->solid[y][x]) free_cells++;
+        }
+    }
+
+    // enche as colunas da esquerda até a fração inicial
+    int to_fill = (int)(free_cells * EULERIAN_INITIAL_FILL);
+    for (int x = 0; x < EULERIAN_WIDTH && to_fill > 0; x++) {
+        for (int y = 0; y < EULERIAN_HEIGHT && to_fill > 0; y++) {
+            if (grid->solid[y][x]) continue;
+            grid->fill[y][x] = EULERIAN_FILL_ONE;
+            grid->total_fill += EULERIAN_FILL_ONE;
+            to_fill--;
+        }
+    }
+}
+
+static void eulerian_apply_gravity(eulerian_t *grid) {
+    fix_t limit = grid->config.max_speed;
+
+    for (int j = 0; j < EULERIAN_HEIGHT; j++) {
+        for (int i = 0; i <= EULERIAN_WIDTH; i++) {
+            grid->u[j][i] = eulerian_u_blocked(grid, i, j) ? 0 : eulerian_clamp(grid->u[j][i] + grid->accel_x, limit);
+        }
+    }
+    for (int j = 0; j <= EULERIAN_HEIGHT; j++) {
+        for (int i = 0; i < EULERIAN_WIDTH; i++) {
+            grid->v[j][i] = eulerian_v_blocked(grid, i, j) ? 0 : eulerian_clamp(grid->v[j][i] + grid->accel_y, limit);
+        }
+    }
+}
+
+static void eulerian_compute_divergence(eulerian_t *grid, uint16_t level) {
+    for (int j = 0; j < EULERIAN_HEIGHT; j++) {
+        for (int i = 0; i < EULERIAN_WIDTH; i++) {
+            if (!eulerian_is_fluid(grid, i, j, level)) {
+                // ar e parede: pressão zero (superfície livre)
+                grid->pressure[j][i] = 0;
+                grid->divergence[j][i] = 0;
+                continue;
+            }
+            grid->divergence[j][i] = grid->u[j][i + 1] - grid->u[j][i] + grid->v[j + 1][i] - grid->v[j][i];
+        }
+    }
+}
+
+// Meia-iteração de Gauss-Seidel sobre as células da cor atual nas linhas [begin, end)
+static void eulerian_relax_rows(void *context, int begin, int end) {
+    eulerian_t *grid = context;
+    uint16_t level = grid->config.fill_level;
+    fix_t overrelax = grid->config.overrelax;
+
+    for (int j = begin; j < end; j++) {
+        for (int i = (j + grid->color) & 1; i < EULERIAN_WIDTH; i += 2) {
+            if (!eulerian_is_fluid(grid, i, j, level)) continue;
+
+            // vizinhos de parede não entram; vizinhos de ar entram com pressão zero
+            fix_t sum = 0;
+            int count = 0;
+            if (!eulerian_is_solid(grid, i - 1, j)) { sum += grid->pressure[j][i - 1]; count++; }
+            if (!eulerian_is_solid(grid, i + 1, j)) { sum += grid->pressure[j][i + 1]; count++; }
+            if (!eulerian_is_solid(grid, i, j - 1)) { sum += grid->pressure[j - 1][i]; count++; }
+            if (!eulerian_is_solid(grid, i, j + 1)) { sum += grid->pressure[j + 1][i]; count++; }
+            if (count == 0) continue;
+
+            fix_t target = fix_mul(sum - grid->divergence[j][i], eulerian_reciprocal[count]);
+            grid->pressure[j][i] += fix_mul(overrelax, target - grid->pressure[j][i]);
+        }
+    }
+}
+
+static void eulerian_project(eulerian_t *grid, uint16_t level) {
+    for (int j = 0; j < EULERIAN_HEIGHT; j++) {
+        for (int i = 1; i < EULERIAN_WIDTH; i++) {
+            if (eulerian_u_blocked(grid, i, j)) continue;
+            if (!eulerian_is_fluid(grid, i - 1, j, level) && !eulerian_is_fluid(grid, i, j, level)) continue;
+            grid->u[j][i] -= grid->pressure[j][i] - grid->pressure[j][i - 1];
+        }
+    }
+    for (int j = 1; j < EULERIAN_HEIGHT; j++) {
+        for (int i = 0; i < EULERIAN_WIDTH; i++) {
+            if (eulerian_v_blocked(grid, i, j)) continue;
+            if (!eulerian_is_fluid(grid, i, j - 1, level) && !eulerian_is_fluid(grid, i, j, level)) continue;
+            grid->v[j][i] -= grid->pressure[j][i] - grid->pressure[j - 1][i];
+        }
+    }
+}
+
+// Advecção semi-Lagrangiana das linhas [begin, end): cada amostra volta pela
+// velocidade local e pega o valor interpolado de onde veio
+static void eulerian_advect_rows(void *context, int begin, int end) {
+    eulerian_t *grid = context;
+
+    for (int j = begin; j < end; j++) {
+        fix_t y_center = FIX_FROM_INT(j) + EULERIAN_HALF;
+
+        if (j < EULERIAN_HEIGHT) {
+            for (int i = 0; i <= EULERIAN_WIDTH; i++) {
+                if (eulerian_u_blocked(grid, i, j)) {
+                    grid->next_u[j][i] = 0;
+                    continue;
+                }
+                fix_t x = FIX_FROM_INT(i);
+                fix_t back_x = x - grid->u[j][i];
+                fix_t back_y = y_center - eulerian_velocity_v(grid, x, y_center);
+                grid->next_u[j][i] = eulerian_velocity_u(grid, back_x, back_y);
+            }
+
+            for (int i = 0; i < EULERIAN_WIDTH; i++) {
+                if (grid->solid[j][i]) {
+                    grid->next_fill[j][i] = 0;
+                    continue;
+                }
+                fix_t x = FIX_FROM_INT(i) + EULERIAN_HALF;
+                fix_t back_x = x - ((grid->u[j][i] + grid->u[j][i + 1]) >> 1);
+                fix_t back_y = y_center - ((grid->v[j][i] + grid->v[j + 1][i]) >> 1);
+                grid->next_fill[j][i] = eulerian_sample_fill(grid, back_x - EULERIAN_HALF, back_y - EULERIAN_HALF);
+            }
+        }
+
+        fix_t y = FIX_FROM_INT(j);
+        for (int i = 0; i < EULERIAN_WIDTH; i++) {
+            if (eulerian_v_blocked(grid, i, j)) {
+                grid->next_v[j][i] = 0;
+                continue;
+            }
+            fix_t x = FIX_FROM_INT(i) + EULERIAN_HALF;
+            fix_t back_x = x - eulerian_velocity_u(grid, x, y);
+            fix_t back_y = y - grid->v[j][i];
+            grid->next_v[j][i] = eulerian_velocity_v(grid, back_x, back_y);
+        }
+    }
+}
+
+// A advecção semi-Lagrangiana perde massa (interpolação suaviza, paredes absorvem):
+// reescala o fill para manter o total inicial. Células cheias não podem crescer,
+// então a diferença vai para as parciais, em algumas passadas
+static void eulerian_conserve_mass(eulerian_t *grid) {
+    for (int pass = 0; pass < 3; pass++) {
+        uint32_t total = 0, partial = 0;
+        for (int j = 0; j < EULERIAN_HEIGHT; j++) {
+            for (int i = 0; i < EULERIAN_WIDTH; i++) {
+                total += grid->fill[j][i];
+                if (grid->fill[j][i] < EULERIAN_FILL_ONE) partial += grid->fill[j][i];
+            }
+        }
+
+        int32_t missing = (int32_t)grid->total_fill - (int32_t)total;
+        if (partial == 0 || missing == 0 || (int32_t)partial + missing <= 0) return;
+
+        uint32_t scale = (uint32_t)(((uint64_t)(partial + missing) << 16) / partial);
+        for (int j = 0; j < EULERIAN_HEIGHT; j++) {
+            for (int i = 0; i < EULERIAN_WIDTH; i++) {
+                if (grid->fill[j][i] >= EULERIAN_FILL_ONE) continue;
+                uint32_t value = (grid->fill[j][i] * scale) >> 16;
+                grid->fill[j][i] = (uint16_t)(value > EULERIAN_FILL_ONE ? EULERIAN_FILL_ONE : value);
+            }
+        }
+    }
+}
+
+void eulerian_step(eulerian_t *grid, fix_t accel_x, fix_t accel_y) {
+    uint16_t level = grid->config.fill_level;
+    grid->accel_x = fix_mul(accel_x, grid->config.gravity);
+    grid->accel_y = fix_mul(accel_y, grid->config.gravity);
+
+    eulerian_apply_gravity(grid);
+    eulerian_compute_divergence(grid, level);
+
+    for (int iteration = 0; iteration < EULERIAN_PRESSURE_ITERATIONS; iteration++) {
+        for (int color = 0; color < 2; color++) {
+            grid->color = color;
+            parallel_for(eulerian_relax_rows, grid, EULERIAN_HEIGHT);
+        }
+    }
+
+    eulerian_project(grid, level);
+
+    parallel_for(eulerian_advect_rows, grid, EULERIAN_HEIGHT + 1);
+    memcpy(grid->u, grid->next_u, sizeof(grid->u));
+    memcpy(grid->v, grid->next_v, sizeof(grid->v));
+    memcpy(grid->fill, grid->next_fill, sizeof(grid->fill));
+
+    eulerian_conserve_mass(grid);
+}
+
+void eulerian_render(const eulerian_t *grid, display *disp) {
+    for (int y = 0; y < EULERIAN_HEIGHT; y++) {
+        // duas linhas de células por página: a de cima no nibble baixo
+        uint8_t *page = &disp->buffer[(y >> 1) * DISPLAY_WIDTH];
+        int shift = (y & 1) * 4;
+
+        for (int x = 0; x < EULERIAN_WIDTH; x++) {
+            int level = (grid->fill[y][x] * 17) >> 12;
+            if (level == 0 || grid->solid[y][x]) continue;
+            if (level > 16) level = 16;
+
+            uint8_t *column = &page[x << EULERIAN_CELL_SHIFT];
+            for (int c = 0; c < 4; c++) column[c] |= (uint8_t)(eulerian_dither[level][c] << shift);
+        }
+    }
+}
+
+uint32_t eulerian_benchmark_step_us(eulerian_t *grid, const occupancy_map_t *walls, int steps) {
+    eulerian_init(grid, walls);
+
+    uint64_t start = time_us_64();
+    for (int i = 0; i < steps; i++) eulerian_step(grid, 0, FIX_ONE);
+    return (uint32_t)((time_us_64() - start) / (uint64_t)steps);
+}
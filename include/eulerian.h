@@ -0,0 +1,96 @@
+#ifndef EULERIAN_H
+#define EULERIAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "physics.h"
+#include "occupancy.h"
+#include "display.h"
+
+/*
+* Fluido em grade (Euleriano) numa grade MAC alinhada às páginas do display
+* Células de 4x4 pixels: a tela de 128x64 vira 32x16 células e cada página
+* de 8 linhas do SSD1306 guarda exatamente duas linhas de células, uma em
+* cada nibble. O desenho é só um OU de nibbles prontos no buffer.
+*
+* Grade MAC: a velocidade horizontal u fica nas faces verticais das células,
+* a vertical v nas faces horizontais, e a pressão e a quantidade de fluido
+* (fill, 0..1) no centro. Cada passo:
+* 1. gravidade (inclinação) nas faces livres
+* 2. divergência e pressão com um número fixo de iterações de Gauss-Seidel
+*    vermelho-preto (células de uma cor não dependem umas das outras, então
+*    as linhas são divididas entre os dois núcleos)
+* 3. projeção: subtrai o gradiente de pressão, zerando a divergência
+* 4. advecção semi-Lagrangiana de u, v e fill (volta pela velocidade e
+*    interpola), com correção global para conservar a massa
+*
+* Orçamento (RP2040, 264 KB de SRAM): o estado inteiro é sizeof(eulerian_t),
+* cerca de 15 KB, limitado a 24 KB em tempo de compilação. O custo por passo
+* é dominado pela pressão: 512 células x EULERIAN_PRESSURE_ITERATIONS
+* atualizações de ~20 ciclos, ou ~200 mil ciclos (1,6 ms a 125 MHz) por núcleo
+* com 20 iterações; a advecção soma ~1500 interpolações bilineares.
+* O benchmark do fluido (FLUID_BENCHMARK) mede o valor real.
+*/
+
+#define EULERIAN_CELL_SHIFT 2
+#define EULERIAN_WIDTH  (DISPLAY_WIDTH >> EULERIAN_CELL_SHIFT)
+#define EULERIAN_HEIGHT (DISPLAY_HEIGHT >> EULERIAN_CELL_SHIFT)
+
+#define EULERIAN_PRESSURE_ITERATIONS 20
+
+// parâmetros padrão, em células e passos
+#define EULERIAN_GRAVITY     0.03f  // células/passo² com 1 g de inclinação
+#define EULERIAN_MAX_SPEED   1.0f   // células/passo (limite de CFL da advecção)
+#define EULERIAN_OVERRELAX   1.5f   // sobre-relaxação do Gauss-Seidel
+#define EULERIAN_FILL_LEVEL  0.5f   // células com fill acima disso são fluido
+#define EULERIAN_INITIAL_FILL 0.35f // fração das células livres cheias no início
+
+typedef struct {
+    fix_t gravity;
+    fix_t max_speed;
+    fix_t overrelax;
+    uint16_t fill_level;  // no formato de fill (Q.12), para comparar direto com as células
+} eulerian_config_t;
+
+typedef struct {
+    eulerian_config_t config;
+
+    // velocidades nas faces (dois buffers para a advecção)
+    fix_t u[EULERIAN_HEIGHT][EULERIAN_WIDTH + 1];
+    fix_t v[EULERIAN_HEIGHT + 1][EULERIAN_WIDTH];
+    fix_t next_u[EULERIAN_HEIGHT][EULERIAN_WIDTH + 1];
+    fix_t next_v[EULERIAN_HEIGHT + 1][EULERIAN_WIDTH];
+
+    // grandezas no centro das células
+    fix_t pressure[EULERIAN_HEIGHT][EULERIAN_WIDTH];
+    fix_t divergence[EULERIAN_HEIGHT][EULERIAN_WIDTH];
+    uint16_t fill[EULERIAN_HEIGHT][EULERIAN_WIDTH];       // Q.12, 0..4096
+    uint16_t next_fill[EULERIAN_HEIGHT][EULERIAN_WIDTH];
+    uint8_t solid[EULERIAN_HEIGHT][EULERIAN_WIDTH];
+
+    uint32_t total_fill;  // massa de referência para a correção
+    fix_t accel_x;
+    fix_t accel_y;
+    int color;            // cor da meia-iteração de Gauss-Seidel em andamento
+} eulerian_t;
+
+_Static_assert(sizeof(eulerian_t) <= 24 * 1024, "o fluido em grade passou do orçamento de memória");
+
+#define EULERIAN_FILL_ONE 4096
+
+void eulerian_config_default(eulerian_config_t *config);
+
+// Marca as paredes a partir do mapa de ocupação e enche a parte esquerda do espaço livre
+void eulerian_init(eulerian_t *grid, const occupancy_map_t *walls);
+
+// Avança um passo com a inclinação (ax, ay) em g
+void eulerian_step(eulerian_t *grid, fix_t accel_x, fix_t accel_y);
+
+// Desenha as células com fluido direto nos bytes do buffer do display (OU),
+// com pontilhado ordenado 4x4 proporcional ao fill
+void eulerian_render(const eulerian_t *grid, display *disp);
+
+// Tempo médio de um passo em microssegundos
+uint32_t eulerian_benchmark_step_us(eulerian_t *grid, const occupancy_map_t *walls, int steps);
+
+#endif
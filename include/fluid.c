@@ -0,0 +1,251 @@
+#include "fluid.h"
+#include "parallel.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// contas de pares em Q.8 (distâncias de até h = 4 pixels cabem folgado em 32 bits)
+#define FLUID_PAIR_BITS  8
+#define FLUID_PAIR_SHIFT (PHYSICS_FRAC_BITS - FLUID_PAIR_BITS)
+#define FLUID_PAIR_ONE   (1 << FLUID_PAIR_BITS)
+#define FLUID_H_PAIR     (1 << (FLUID_PAIR_BITS + FLUID_H_SHIFT))
+
+#define FLUID_MAX_PRESSURE FIX_FROM_INT(4)
+
+// produtos e somas da relaxação: com as pressões limitadas a ±4, (P_i + P_j) * w e
+// push * dx ficam abaixo de 2^29 em Q.16 (e a soma dos vizinhos cabe em 32 bits), mas
+// crescem com os bits fracionários (2^33 em Q.20); acima de Q.16 eles são feitos em
+// 64 bits, e em Q.16 continuam em 32
+#if PHYSICS_FRAC_BITS > 16
+typedef int64_t fluid_pair_t;
+#else
+typedef int32_t fluid_pair_t;
+#endif
+
+_Static_assert(PHYSICS_FRAC_BITS >= FLUID_PAIR_BITS, "o fluido precisa de pelo menos 8 bits fracionários");
+_Static_assert(FLUID_MAX_PARTICLES <= 65535, "os índices da grade são de 16 bits");
+
+// Q.16 (somatórios de pesos) -> ponto fixo da física
+static inline fix_t fluid_from_q16(int32_t value) {
+#if PHYSICS_FRAC_BITS >= 16
+    return value << (PHYSICS_FRAC_BITS - 16);
+#else
+    return value >> (16 - PHYSICS_FRAC_BITS);
+#endif
+}
+
+static inline fix_t fluid_clamp(fix_t value, fix_t limit) {
+    return value > limit ? limit : (value < -limit ? -limit : value);
+}
+
+static inline fix_t fluid_clamp_pair(fluid_pair_t value, fix_t limit) {
+    return (fix_t)(value > limit ? limit : (value < -limit ? -limit : value));
+}
+
+// Raiz quadrada inteira de 32 bits (piso)
+static uint32_t fluid_isqrt32(uint32_t value) {
+    uint32_t result = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > value) bit >>= 2;
+
+    while (bit != 0) {
+        if (value >= result + bit) {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return result;
+}
+
+void fluid_config_default(fluid_config_t *config) {
+    config->gravity = FIX_FROM_FLOAT(FLUID_GRAVITY);
+    config->rest_density = FIX_FROM_FLOAT(FLUID_REST_DENSITY);
+    config->stiffness = FIX_FROM_FLOAT(FLUID_STIFFNESS);
+    config->near_stiffness = FIX_FROM_FLOAT(FLUID_NEAR_STIFFNESS);
+    config->damping = FIX_FROM_FLOAT(FLUID_DAMPING);
+    config->max_speed = FIX_FROM_FLOAT(FLUID_MAX_SPEED);
+    config->particle_radius = FIX_FROM_FLOAT(FLUID_PARTICLE_RADIUS);
+}
+
+int fluid_init(fluid_t *fluid, const sdf_t *walls, int count) {
+    if (count > FLUID_MAX_PARTICLES) count = FLUID_MAX_PARTICLES;
+
+    fluid_config_default(&fluid->config);
+    fluid->walls = walls;
+    fluid->accel_x = 0;
+    fluid->accel_y = 0;
+    fluid->count = 0;
+    spatial_hash_init(&fluid->hash, fluid->cell_start, fluid->sorted, fluid->cell,
+                      FLUID_MAX_PARTICLES, FLUID_HASH_WIDTH, FLUID_HASH_HEIGHT, FLUID_H_SHIFT);
+
+    // grade regular no espaço livre, varrendo a tela de cima para baixo
+    fix_t clearance = fluid->config.particle_radius + FIX_ONE / 2;
+    for (int y = 1; y < DISPLAY_HEIGHT && fluid->count < count; y += FLUID_SPAWN_SPACING) {
+        for (int x = 1; x < DISPLAY_WIDTH && fluid->count < count; x += FLUID_SPAWN_SPACING) {
+            fix_t px = FIX_FROM_INT(x);
+            fix_t py = FIX_FROM_INT(y);
+            if (sdf_distance(walls, px, py) < clearance) continue;
+
+            int i = fluid->count++;
+            fluid->x[i] = fluid->prev_x[i] = px;
+            fluid->y[i] = fluid->prev_y[i] = py;
+        }
+    }
+    return fluid->count;
+}
+
+// Fase 1: inércia + gravidade (Verlet) e célula de cada partícula
+static void fluid_integrate(void *context, int begin, int end) {
+    fluid_t *fluid = context;
+    const fluid_config_t *config = &fluid->config;
+
+    for (int i = begin; i < end; i++) {
+        fix_t vx = fix_mul(fluid->x[i] - fluid->prev_x[i], config->damping) + fluid->accel_x;
+        fix_t vy = fix_mul(fluid->y[i] - fluid->prev_y[i], config->damping) + fluid->accel_y;
+        vx = fluid_clamp(vx, config->max_speed);
+        vy = fluid_clamp(vy, config->max_speed);
+
+        fluid->prev_x[i] = fluid->x[i];
+        fluid->prev_y[i] = fluid->y[i];
+        fluid->x[i] += vx;
+        fluid->y[i] += vy;
+
+        fluid->cell[i] = spatial_hash_cell_of(&fluid->hash, fluid->x[i], fluid->y[i]);
+    }
+}
+
+// Percorre os vizinhos a menos de h da partícula i; o corpo recebe j, dx, dy (Q.8, de i para j),
+// r² e o peso w = 1 - r/h em Q.8
+#define FLUID_FOR_EACH_NEIGHBOUR(fluid, i, ...)                                               \
+    SPATIAL_HASH_FOR_EACH_NEAR(&(fluid)->hash, (fluid)->cell[i], j, {                         \
+        if (j == (i)) continue;                                                               \
+        int32_t dx = ((fluid)->x[j] - (fluid)->x[i]) >> FLUID_PAIR_SHIFT;                     \
+        int32_t dy = ((fluid)->y[j] - (fluid)->y[i]) >> FLUID_PAIR_SHIFT;                     \
+        if (dx >= FLUID_H_PAIR || dx <= -FLUID_H_PAIR ||                                      \
+            dy >= FLUID_H_PAIR || dy <= -FLUID_H_PAIR) continue;                              \
+        int32_t r_sq = dx * dx + dy * dy;                                                     \
+        if (r_sq >= FLUID_H_PAIR * FLUID_H_PAIR) continue;                                    \
+        int32_t r = (int32_t)fluid_isqrt32((uint32_t)r_sq);                                   \
+        int32_t w = FLUID_PAIR_ONE - (r >> FLUID_H_SHIFT);                                    \
+        __VA_ARGS__                                                                           \
+    })
+
+// Fase 2: densidade e densidade próxima -> pressões
+static void fluid_density(void *context, int begin, int end) {
+    fluid_t *fluid = context;
+    const fluid_config_t *config = &fluid->config;
+
+    for (int i = begin; i < end; i++) {
+        int32_t density = 0;
+        int32_t near_density = 0;
+
+        FLUID_FOR_EACH_NEIGHBOUR(fluid, i, {
+            (void)r;
+            int32_t w_sq = w * w;
+            density += w_sq;
+            near_density += (w_sq * w) >> FLUID_PAIR_BITS;
+        });
+
+        // limitadas para que as contas de pares não estourem 32 bits num amontoado
+        fix_t pressure = fix_mul(config->stiffness, fluid_from_q16(density) - config->rest_density);
+        fix_t near_pressure = fix_mul(config->near_stiffness, fluid_from_q16(near_density));
+        fluid->pressure[i] = fluid_clamp(pressure, FLUID_MAX_PRESSURE);
+        fluid->near_pressure[i] = fluid_clamp(near_pressure, FLUID_MAX_PRESSURE);
+    }
+}
+
+// Fase 3: deslocamento de relaxação. A versão original aplica metade em cada
+// partícula do par; aqui cada partícula soma a sua parte dos dois lados
+// (pressão de i e de j), o que dá o mesmo resultado sem escrever em j
+static void fluid_relax(void *context, int begin, int end) {
+    fluid_t *fluid = context;
+
+    for (int i = begin; i < end; i++) {
+        fluid_pair_t delta_x = 0;
+        fluid_pair_t delta_y = 0;
+        fix_t pressure = fluid->pressure[i];
+        fix_t near_pressure = fluid->near_pressure[i];
+
+        FLUID_FOR_EACH_NEIGHBOUR(fluid, i, {
+            if (r == 0) {
+                // partículas coincidentes: separa numa direção fixa pela ordem dos índices
+                delta_x += j > i ? -(FIX_ONE >> 4) : (FIX_ONE >> 4);
+                continue;
+            }
+
+            // Clavet: (P_i + P_j) * w + (N_i + N_j) * w², metade para cada lado, com w em
+            // Q.8 (o tamanho dos produtos está em fluid_pair_t)
+            fluid_pair_t near_term = (((fluid_pair_t)near_pressure + fluid->near_pressure[j]) * w) >> FLUID_PAIR_BITS;
+            fluid_pair_t pressure_sum = (fluid_pair_t)pressure + fluid->pressure[j];
+            fix_t push = (fix_t)((pressure_sum * w + near_term * w) >> (FLUID_PAIR_BITS + 1));
+
+            // push * (dx, dy) / r: empurra i para longe de j
+            delta_x -= (fluid_pair_t)push * dx / r;
+            delta_y -= (fluid_pair_t)push * dy / r;
+        });
+
+        // o deslocamento de um passo já sai limitado à velocidade máxima
+        fluid->delta_x[i] = fluid_clamp_pair(delta_x, fluid->config.max_speed);
+        fluid->delta_y[i] = fluid_clamp_pair(delta_y, fluid->config.max_speed);
+    }
+}
+
+// Fase 4: aplica o deslocamento e resolve as paredes pelo campo de distância
+static void fluid_apply(void *context, int begin, int end) {
+    fluid_t *fluid = context;
+    const fluid_config_t *config = &fluid->config;
+    fix_t radius = config->particle_radius;
+
+    for (int i = begin; i < end; i++) {
+        fix_t x = fluid->x[i] + fluid->delta_x[i];
+        fix_t y = fluid->y[i] + fluid->delta_y[i];
+
+        fix_t normal_x, normal_y;
+        fix_t distance = sdf_query(fluid->walls, x, y, &normal_x, &normal_y);
+        if (distance < radius) {
+            // a velocidade é medida antes do empurrão, para que ele não vire energia
+            fix_t vx = x - fluid->prev_x[i];
+            fix_t vy = y - fluid->prev_y[i];
+
+            x += fix_mul(normal_x, radius - distance);
+            y += fix_mul(normal_y, radius - distance);
+
+            // contato sem quique: remove a componente contra a parede
+            fix_t normal_speed = fix_mul(vx, normal_x) + fix_mul(vy, normal_y);
+            if (normal_speed < 0) {
+                vx -= fix_mul(normal_speed, normal_x);
+                vy -= fix_mul(normal_speed, normal_y);
+            }
+            fluid->prev_x[i] = x - vx;
+            fluid->prev_y[i] = y - vy;
+        }
+
+        fluid->x[i] = x;
+        fluid->y[i] = y;
+    }
+}
+
+void fluid_step(fluid_t *fluid, fix_t accel_x, fix_t accel_y) {
+    fluid->accel_x = fix_mul(accel_x, fluid->config.gravity);
+    fluid->accel_y = fix_mul(accel_y, fluid->config.gravity);
+
+    parallel_for(fluid_integrate, fluid, fluid->count);
+    spatial_hash_sort(&fluid->hash, fluid->count);
+    parallel_for(fluid_density, fluid, fluid->count);
+    parallel_for(fluid_relax, fluid, fluid->count);
+    parallel_for(fluid_apply, fluid, fluid->count);
+}
+
+uint32_t fluid_benchmark_step_us(fluid_t *fluid, const sdf_t *walls, int count, int steps) {
+    fluid_init(fluid, walls, count);
+
+    // alguns passos para o fluido assentar antes de medir
+    for (int i = 0; i < 16; i++) fluid_step(fluid, 0, FIX_ONE);
+
+    uint64_t start = time_us_64();
+    for (int i = 0; i < steps; i++) fluid_step(fluid, 0, FIX_ONE);
+    return (uint32_t)((time_us_64() - start) / (uint64_t)steps);
+}
@@ -0,0 +1,96 @@
+#ifndef FLUID_H
+#define FLUID_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "physics.h"
+#include "sdf.h"
+#include "display.h"
+#include "spatial_hash.h"
+
+/*
+* Fluido de partículas (relaxação de dupla densidade, Clavet et al. 2005)
+* É um SPH baseado em posições: a cada passo as partículas andam por inércia
+* e gravidade, e depois as posições são corrigidas para aproximar a densidade
+* local da densidade de repouso. A "densidade próxima" impede que partículas
+* se amontoem e dá tensão superficial de graça.
+*
+* - as partículas ficam em arrays separados por campo (x[], y[], ...), o que
+*   mantém os laços enxutos e fáceis de dividir entre os núcleos
+* - os vizinhos vêm de uma grade uniforme (spatial_hash) com células do
+*   tamanho do raio de interação h, montada a cada passo
+* - a relaxação é feita no estilo Jacobi (cada partícula só escreve em si
+*   mesma), então cada fase é dividida entre os dois núcleos sem travas
+* - tudo em ponto fixo; as contas de pares usam Q.8 para caber em 32 bits
+*/
+
+#define FLUID_MAX_PARTICLES 512
+
+// raio de interação h = 2^shift pixels (também é o lado da célula da grade)
+#define FLUID_H_SHIFT 2
+#define FLUID_HASH_WIDTH  (DISPLAY_WIDTH >> FLUID_H_SHIFT)
+#define FLUID_HASH_HEIGHT (DISPLAY_HEIGHT >> FLUID_H_SHIFT)
+
+// distância entre partículas na criação, em pixels
+#define FLUID_SPAWN_SPACING 2
+
+// parâmetros padrão, por passo do fluido
+#define FLUID_GRAVITY        0.04f  // pixels/passo² com 1 g de inclinação
+#define FLUID_REST_DENSITY   2.0f
+#define FLUID_STIFFNESS      0.08f
+#define FLUID_NEAR_STIFFNESS 0.3f
+#define FLUID_DAMPING        0.99f
+#define FLUID_MAX_SPEED      2.0f   // pixels/passo; menor que meia parede para não atravessar
+#define FLUID_PARTICLE_RADIUS 0.5f
+
+typedef struct {
+    fix_t gravity;
+    fix_t rest_density;
+    fix_t stiffness;
+    fix_t near_stiffness;
+    fix_t damping;
+    fix_t max_speed;
+    fix_t particle_radius;
+} fluid_config_t;
+
+typedef struct {
+    int count;
+    fluid_config_t config;
+    const sdf_t *walls;
+
+    // estado (posição atual e anterior: a velocidade é a diferença)
+    fix_t x[FLUID_MAX_PARTICLES];
+    fix_t y[FLUID_MAX_PARTICLES];
+    fix_t prev_x[FLUID_MAX_PARTICLES];
+    fix_t prev_y[FLUID_MAX_PARTICLES];
+
+    // rascunho de cada passo
+    fix_t pressure[FLUID_MAX_PARTICLES];
+    fix_t near_pressure[FLUID_MAX_PARTICLES];
+    fix_t delta_x[FLUID_MAX_PARTICLES];
+    fix_t delta_y[FLUID_MAX_PARTICLES];
+
+    // grade de vizinhança e seu armazenamento
+    spatial_hash_t hash;
+    uint16_t cell[FLUID_MAX_PARTICLES];
+    uint16_t cell_start[FLUID_HASH_WIDTH * FLUID_HASH_HEIGHT + 1];
+    uint16_t sorted[FLUID_MAX_PARTICLES];
+
+    // aceleração do passo atual (inclinação * gravidade)
+    fix_t accel_x;
+    fix_t accel_y;
+} fluid_t;
+
+void fluid_config_default(fluid_config_t *config);
+
+// Preenche o espaço livre a partir do canto superior esquerdo com até count partículas
+// Retorna quantas couberam
+int fluid_init(fluid_t *fluid, const sdf_t *walls, int count);
+
+// Avança um passo com a inclinação (ax, ay) em g
+void fluid_step(fluid_t *fluid, fix_t accel_x, fix_t accel_y);
+
+// Tempo médio de um passo em microssegundos com count partículas
+uint32_t fluid_benchmark_step_us(fluid_t *fluid, const sdf_t *walls, int count, int steps);
+
+#endif
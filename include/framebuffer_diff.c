@@ -0,0 +1,62 @@
+#include "framebuffer_diff.h"
+#include <string.h>
+
+// palavra que pode apontar para o buffer de bytes sem violar o aliasing
+typedef uint32_t __attribute__((may_alias)) framebuffer_word_t;
+
+#define FRAMEBUFFER_WORDS_PER_PAGE (DISPLAY_WIDTH / 4)
+
+_Static_assert(DISPLAY_WIDTH % 4 == 0, "a linha precisa ter um número inteiro de palavras");
+
+// primeiro e último byte diferente dentro da palavra (little-endian: o byte 0 é o de baixo)
+static inline int framebuffer_first_byte(uint32_t changed) {
+    return __builtin_ctz(changed) >> 3;
+}
+
+static inline int framebuffer_last_byte(uint32_t changed) {
+    return (31 - __builtin_clz(changed)) >> 3;
+}
+
+int framebuffer_diff(const uint8_t *current, const uint8_t *previous, int merge_gap,
+                     framebuffer_span_t *spans) {
+    const framebuffer_word_t *now = (const framebuffer_word_t *)current;
+    const framebuffer_word_t *before = (const framebuffer_word_t *)previous;
+    int count = 0;
+
+    for (int page = 0; page < FRAMEBUFFER_PAGES; page++) {
+        int page_first = count;
+
+        for (int word = 0; word < FRAMEBUFFER_WORDS_PER_PAGE; word++) {
+            uint32_t changed = now[word] ^ before[word];
+            if (!changed) continue;
+
+            int start = word * 4 + framebuffer_first_byte(changed);
+            int end = word * 4 + framebuffer_last_byte(changed);
+            framebuffer_span_t *last = count > page_first ? &spans[count - 1] : NULL;
+
+            // perto do trecho anterior (ou sem espaço para outro): estende ele
+            if (last && (start - last->end - 1 <= merge_gap ||
+                         count - page_first == FRAMEBUFFER_MAX_SPANS_PER_PAGE)) {
+                last->end = (uint8_t)end;
+            } else {
+                spans[count++] = (framebuffer_span_t){ (uint8_t)page, (uint8_t)start, (uint8_t)end };
+            }
+        }
+
+        now += FRAMEBUFFER_WORDS_PER_PAGE;
+        before += FRAMEBUFFER_WORDS_PER_PAGE;
+    }
+    return count;
+}
+
+int framebuffer_full(framebuffer_span_t *spans) {
+    for (int page = 0; page < FRAMEBUFFER_PAGES; page++) {
+        spans[page] = (framebuffer_span_t){ (uint8_t)page, 0, DISPLAY_WIDTH - 1 };
+    }
+    return FRAMEBUFFER_PAGES;
+}
+
+void framebuffer_commit(uint8_t *previous, const uint8_t *current, const framebuffer_span_t *span) {
+    int offset = span->page * DISPLAY_WIDTH + span->start;
+    memcpy(previous + offset, current + offset, framebuffer_span_length(span));
+}
@@ -0,0 +1,50 @@
+#ifndef FRAMEBUFFER_DIFF_H
+#define FRAMEBUFFER_DIFF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display.h"
+
+/*
+* Diferença entre o quadro novo e o último enviado
+* Compara as páginas de 4 em 4 bytes e devolve, por página, os trechos de
+* colunas que mudaram. Dois trechos da mesma página só ficam separados se o
+* intervalo sem mudança entre eles for maior que merge_gap: abaixo disso sai
+* mais barato mandar as colunas repetidas do que abrir outra janela (o custo
+* fixo de cada trecho depende do destino: comandos no I2C, cabeçalho no USB;
+* como a busca é por palavra, merge_gap precisa ser pelo menos 3).
+*
+* Quem envia guarda a própria cópia do que o destino tem (o display e o
+* espelho pelo USB andam em ritmos diferentes) e atualiza só o que conseguiu
+* enviar, com framebuffer_commit.
+*/
+
+#define FRAMEBUFFER_PAGES (DISPLAY_HEIGHT / 8)
+#define FRAMEBUFFER_SIZE (DISPLAY_WIDTH * FRAMEBUFFER_PAGES)
+
+// trechos por página; passando disso o último absorve o resto da página
+#define FRAMEBUFFER_MAX_SPANS_PER_PAGE 4
+#define FRAMEBUFFER_MAX_SPANS (FRAMEBUFFER_PAGES * FRAMEBUFFER_MAX_SPANS_PER_PAGE)
+
+typedef struct {
+    uint8_t page;
+    uint8_t start;   // primeira coluna alterada
+    uint8_t end;     // última coluna alterada (inclusive)
+} framebuffer_span_t;
+
+// Preenche spans (até FRAMEBUFFER_MAX_SPANS, em ordem de página e coluna) e retorna
+// quantos são; os dois buffers precisam estar alinhados em 4 bytes
+int framebuffer_diff(const uint8_t *current, const uint8_t *previous, int merge_gap,
+                     framebuffer_span_t *spans);
+
+// Um trecho por página cobrindo a linha inteira (para quando a cópia não vale)
+int framebuffer_full(framebuffer_span_t *spans);
+
+// Copia o trecho de current para previous depois de enviado
+void framebuffer_commit(uint8_t *previous, const uint8_t *current, const framebuffer_span_t *span);
+
+static inline int framebuffer_span_length(const framebuffer_span_t *span) {
+    return span->end - span->start + 1;
+}
+
+#endif
@@ -0,0 +1,231 @@
+#include "fusion.h"
+#include "hardware/structs/systick.h"
+#include <string.h>
+
+#define FUSION_PI 3.14159265f
+#define FUSION_RAD_TO_DEG (180.0f / FUSION_PI)
+
+// Raiz quadrada inversa pela aproximação de bits + uma iteração de Newton (~0.2% de erro)
+float fusion_inv_sqrt(float x) {
+    union {
+        float f;
+        uint32_t i;
+    } conv = {.f = x};
+
+    conv.i = 0x5F3759DFu - (conv.i >> 1);
+    conv.f *= 1.5f - (0.5f * x * conv.f * conv.f);
+    return conv.f;
+}
+
+// atan2 por polinômio de ordem 7 no intervalo [0, 1] (erro < 2e-4 rad)
+float fusion_atan2(float y, float x) {
+    float abs_x = x < 0 ? -x : x;
+    float abs_y = y < 0 ? -y : y;
+
+    if (abs_x == 0.0f && abs_y == 0.0f) return 0.0f;
+
+    float a = abs_x > abs_y ? abs_y / abs_x : abs_x / abs_y;
+    float s = a * a;
+    float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+
+    if (abs_y > abs_x) r = FUSION_PI / 2 - r;
+    if (x < 0) r = FUSION_PI - r;
+    if (y < 0) r = -r;
+    return r;
+}
+
+void fusion_init(fusion_t *fusion, fusion_mode_t mode, const mpu6050_t *mpu, int rate_hz) {
+    if (rate_hz <= 0) rate_hz = FUSION_DEFAULT_RATE_HZ;
+
+    fusion->mode = mode;
+    fusion->dt = 1.0f / (float)rate_hz;
+    fusion->alpha = FUSION_DEFAULT_ALPHA;
+    fusion->beta = FUSION_DEFAULT_BETA;
+    // as divisões ficam aqui para o laço usar só multiplicações
+    fusion->accel_to_g = 1.0f / mpu->accel_scale_factor;
+    fusion->gyro_to_rad = (FUSION_PI / 180.0f) / mpu->gyro_scale_factor;
+    fusion_reset(fusion);
+}
+
+// Volta para a orientação nivelada
+void fusion_reset(fusion_t *fusion) {
+    fusion->q[0] = 1.0f;
+    fusion->q[1] = 0.0f;
+    fusion->q[2] = 0.0f;
+    fusion->q[3] = 0.0f;
+    fusion->gravity[0] = 0.0f;
+    fusion->gravity[1] = 0.0f;
+    fusion->gravity[2] = 1.0f;
+}
+
+// Filtro complementar sobre o vetor gravidade
+static void fusion_update_complementary(fusion_t *fusion, float ax, float ay, float az,
+                                        float gx, float gy, float gz, float accel_norm_sq) {
+    float *v = fusion->gravity;
+    float dt = fusion->dt;
+
+    // no referencial da placa, um vetor fixo no mundo gira com -w: dv/dt = v x w
+    float vx = v[0] + dt * (v[1] * gz - v[2] * gy);
+    float vy = v[1] + dt * (v[2] * gx - v[0] * gz);
+    float vz = v[2] + dt * (v[0] * gy - v[1] * gx);
+
+    // só confia no acelerômetro quando ele mede aproximadamente 1g
+    float low = 1.0f - FUSION_ACCEL_REJECT_G;
+    float high = 1.0f + FUSION_ACCEL_REJECT_G;
+    if (accel_norm_sq > low * low && accel_norm_sq < high * high) {
+        float inv = fusion_inv_sqrt(accel_norm_sq);
+        float k = 1.0f - fusion->alpha;
+        vx = fusion->alpha * vx + k * ax * inv;
+        vy = fusion->alpha * vy + k * ay * inv;
+        vz = fusion->alpha * vz + k * az * inv;
+    }
+
+    float inv = fusion_inv_sqrt(vx * vx + vy * vy + vz * vz);
+    v[0] = vx * inv;
+    v[1] = vy * inv;
+    v[2] = vz * inv;
+}
+
+// Filtro de Madgwick (versão IMU, sem magnetômetro)
+static void fusion_update_madgwick(fusion_t *fusion, float ax, float ay, float az,
+                                   float gx, float gy, float gz, float accel_norm_sq) {
+    float q0 = fusion->q[0], q1 = fusion->q[1], q2 = fusion->q[2], q3 = fusion->q[3];
+
+    // derivada do quatérnio pela velocidade angular
+    float dq0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float dq1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float dq2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float dq3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    float low = 1.0f - FUSION_ACCEL_REJECT_G;
+    float high = 1.0f + FUSION_ACCEL_REJECT_G;
+    if (accel_norm_sq > low * low && accel_norm_sq < high * high) {
+        float inv = fusion_inv_sqrt(accel_norm_sq);
+        ax *= inv;
+        ay *= inv;
+        az *= inv;
+
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        // gradiente da função objetivo (gravidade estimada - medida)
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+        float norm_sq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (norm_sq > 0.0f) {
+            float k = fusion->beta * fusion_inv_sqrt(norm_sq);
+            dq0 -= k * s0;
+            dq1 -= k * s1;
+            dq2 -= k * s2;
+            dq3 -= k * s3;
+        }
+    }
+
+    q0 += dq0 * fusion->dt;
+    q1 += dq1 * fusion->dt;
+    q2 += dq2 * fusion->dt;
+    q3 += dq3 * fusion->dt;
+
+    float inv = fusion_inv_sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= inv;
+    q1 *= inv;
+    q2 *= inv;
+    q3 *= inv;
+
+    fusion->q[0] = q0;
+    fusion->q[1] = q1;
+    fusion->q[2] = q2;
+    fusion->q[3] = q3;
+
+    // gravidade no referencial da placa a partir do quatérnio
+    fusion->gravity[0] = 2.0f * (q1 * q3 - q0 * q2);
+    fusion->gravity[1] = 2.0f * (q0 * q1 + q2 * q3);
+    fusion->gravity[2] = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+}
+
+void fusion_update(fusion_t *fusion, const mpu6050_raw_data_t *raw) {
+    float ax = raw->accel_x * fusion->accel_to_g;
+    float ay = raw->accel_y * fusion->accel_to_g;
+    float az = raw->accel_z * fusion->accel_to_g;
+    float gx = raw->gyro_x * fusion->gyro_to_rad;
+    float gy = raw->gyro_y * fusion->gyro_to_rad;
+    float gz = raw->gyro_z * fusion->gyro_to_rad;
+    float accel_norm_sq = ax * ax + ay * ay + az * az;
+
+    if (fusion->mode == FUSION_MADGWICK) {
+        fusion_update_madgwick(fusion, ax, ay, az, gx, gy, gz, accel_norm_sq);
+    } else {
+        fusion_update_complementary(fusion, ax, ay, az, gx, gy, gz, accel_norm_sq);
+    }
+}
+
+void fusion_get_gravity(const fusion_t *fusion, float *x, float *y, float *z) {
+    *x = fusion->gravity[0];
+    *y = fusion->gravity[1];
+    *z = fusion->gravity[2];
+}
+
+// Mesmas convenções de mpu6050_calculate_pitch/roll
+float fusion_get_pitch(const fusion_t *fusion) {
+    const float *v = fusion->gravity;
+    float norm_sq = v[1] * v[1] + v[2] * v[2];
+    // sqrt(x) = x * (1 / sqrt(x))
+    return fusion_atan2(-v[0], norm_sq * fusion_inv_sqrt(norm_sq)) * FUSION_RAD_TO_DEG;
+}
+
+float fusion_get_roll(const fusion_t *fusion) {
+    return fusion_atan2(fusion->gravity[1], fusion->gravity[2]) * FUSION_RAD_TO_DEG;
+}
+
+// Executa o filtro com dados sintéticos e mede cada atualização com o SysTick
+// (contador decrescente de 24 bits no clock do processador)
+uint32_t fusion_benchmark_cycles(fusion_mode_t mode, int iterations) {
+    if (iterations <= 0) return 0;
+
+    mpu6050_t mpu;
+    memset(&mpu, 0, sizeof(mpu));
+    mpu.accel_scale_factor = mpu6050_get_accel_sensitivity(MPU6050_ACCEL_SCALE_2G);
+    mpu.gyro_scale_factor = mpu6050_get_gyro_sensitivity(MPU6050_GYRO_SCALE_250DPS);
+
+    fusion_t fusion;
+    fusion_init(&fusion, mode, &mpu, FUSION_DEFAULT_RATE_HZ);
+
+    uint32_t saved_csr = systick_hw->csr;
+    uint32_t saved_rvr = systick_hw->rvr;
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // habilita, usando o clock do processador
+
+    // custo da própria medição
+    uint32_t start = systick_hw->cvr;
+    uint32_t overhead = (start - systick_hw->cvr) & 0x00FFFFFF;
+
+    uint64_t total = 0;
+    for (int i = 0; i < iterations; i++) {
+        mpu6050_raw_data_t raw = {
+            .accel_x = (int16_t)(800 + (i & 63)),
+            .accel_y = (int16_t)(-400 - (i & 31)),
+            .accel_z = (int16_t)(16000 + (i & 127)),
+            .gyro_x = (int16_t)((i & 15) - 8),
+            .gyro_y = (int16_t)(40 - (i & 7)),
+            .gyro_z = (int16_t)(-20 + (i & 3)),
+        };
+
+        start = systick_hw->cvr;
+        fusion_update(&fusion, &raw);
+        uint32_t elapsed = (start - systick_hw->cvr) & 0x00FFFFFF;
+        total += elapsed > overhead ? elapsed - overhead : 0;
+    }
+
+    systick_hw->csr = 0;
+    systick_hw->rvr = saved_rvr;
+    systick_hw->csr = saved_csr;
+
+    return (uint32_t)(total / (uint32_t)iterations);
+}
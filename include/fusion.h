@@ -0,0 +1,62 @@
+#ifndef FUSION_H
+#define FUSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mpu6050.h"
+
+/*
+* Fusão de acelerômetro e giroscópio para estimar a orientação
+* O acelerômetro sozinho é ruidoso e confunde chacoalhões com inclinação;
+* o giroscópio sozinho deriva. Os dois filtros abaixo combinam os sensores a
+* uma taxa fixa e entregam o vetor gravidade no referencial da placa:
+* - complementar: gira o vetor gravidade com o giroscópio e puxa aos poucos para o acelerômetro
+* - Madgwick: mantém um quatérnio corrigido por descida de gradiente
+* Como o Cortex-M0+ não tem FPU, raiz inversa e atan2 usam aproximações rápidas.
+*/
+
+#define FUSION_DEFAULT_RATE_HZ  100
+#define FUSION_DEFAULT_ALPHA    0.98f  // peso do giroscópio no filtro complementar
+#define FUSION_DEFAULT_BETA     0.1f   // ganho do gradiente no filtro de Madgwick
+
+// Faixa de |a| (em g) aceita como gravidade pura; fora dela a correção pelo acelerômetro é ignorada
+#define FUSION_ACCEL_REJECT_G   0.15f
+
+typedef enum {
+    FUSION_COMPLEMENTARY = 0,
+    FUSION_MADGWICK = 1
+} fusion_mode_t;
+
+typedef struct {
+    fusion_mode_t mode;
+    float dt;               // período de amostragem em segundos
+    float alpha;
+    float beta;
+    float accel_to_g;       // conversão LSB -> g
+    float gyro_to_rad;      // conversão LSB -> rad/s
+    float q[4];             // quatérnio (w, x, y, z) do filtro de Madgwick
+    float gravity[3];       // vetor gravidade unitário no referencial da placa
+} fusion_t;
+
+// Configura o filtro para a escala atual do sensor e a taxa de atualização
+void fusion_init(fusion_t *fusion, fusion_mode_t mode, const mpu6050_t *mpu, int rate_hz);
+void fusion_reset(fusion_t *fusion);
+
+// Incorpora uma leitura bruta (já corrigida pelos offsets)
+void fusion_update(fusion_t *fusion, const mpu6050_raw_data_t *raw);
+
+// Vetor gravidade estimado (unitário, mesmo sentido da leitura do acelerômetro em repouso)
+void fusion_get_gravity(const fusion_t *fusion, float *x, float *y, float *z);
+
+// Ângulos em graus calculados a partir do vetor gravidade
+float fusion_get_pitch(const fusion_t *fusion);
+float fusion_get_roll(const fusion_t *fusion);
+
+// Aproximações rápidas
+float fusion_inv_sqrt(float x);
+float fusion_atan2(float y, float x);
+
+// Mede o custo médio de fusion_update em ciclos de clock (SysTick)
+uint32_t fusion_benchmark_cycles(fusion_mode_t mode, int iterations);
+
+#endif
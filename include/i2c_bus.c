@@ -0,0 +1,91 @@
+#include "i2c_bus.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "pico/stdlib.h"
+
+// meio período do clock gerado na limpeza (~100 kHz, que qualquer escravo aceita)
+#define I2C_BUS_CLEAR_HALF_PERIOD_US 5
+
+// folga para o clock stretching e para o início da transferência
+#define I2C_BUS_TIMEOUT_MARGIN_US 1000
+
+// o dobro do tempo no barramento (9 bits por byte, com o endereço) mais a folga
+static uint32_t i2c_bus_timeout_us(uint32_t baudrate, size_t length) {
+    uint32_t bits = (uint32_t)(length + 1) * 9;
+    return 2 * (uint32_t)((uint64_t)bits * 1000000 / (baudrate ? baudrate : 100000)) + I2C_BUS_TIMEOUT_MARGIN_US;
+}
+
+static bool i2c_bus_result(int result, size_t length, i2c_bus_stats_t *stats) {
+    if (result == (int)length) {
+        stats->consecutive = 0;
+        return true;
+    }
+    stats->errors++;
+    stats->consecutive++;
+    if (result == PICO_ERROR_TIMEOUT) stats->timeouts++;
+    return false;
+}
+
+bool i2c_bus_write(struct i2c_inst *i2c, uint8_t address, const uint8_t *src, size_t length, bool nostop,
+                   uint32_t baudrate, i2c_bus_stats_t *stats) {
+    int result = i2c_write_timeout_us(i2c, address, src, length, nostop, i2c_bus_timeout_us(baudrate, length));
+    return i2c_bus_result(result, length, stats);
+}
+
+bool i2c_bus_read(struct i2c_inst *i2c, uint8_t address, uint8_t *dst, size_t length, bool nostop,
+                  uint32_t baudrate, i2c_bus_stats_t *stats) {
+    int result = i2c_read_timeout_us(i2c, address, dst, length, nostop, i2c_bus_timeout_us(baudrate, length));
+    return i2c_bus_result(result, length, stats);
+}
+
+bool i2c_bus_needs_recovery(const i2c_bus_stats_t *stats) {
+    return stats->consecutive >= I2C_BUS_RECOVERY_THRESHOLD &&
+           time_us_32() - stats->last_recovery_us >= I2C_BUS_RECOVERY_INTERVAL_US;
+}
+
+void i2c_bus_recovered(i2c_bus_stats_t *stats) {
+    stats->recoveries++;
+    stats->consecutive = 0;
+    stats->last_recovery_us = time_us_32();
+}
+
+// o mestre imita o coletor aberto: para nível alto solta o pino (entrada com pull-up),
+// para nível baixo o puxa para o terra
+static void i2c_bus_line(unsigned int pin, bool high) {
+    gpio_set_dir(pin, high ? GPIO_IN : GPIO_OUT);
+}
+
+bool i2c_bus_clear(unsigned int sda_pin, unsigned int scl_pin) {
+    gpio_init(sda_pin);
+    gpio_init(scl_pin);
+    gpio_pull_up(sda_pin);
+    gpio_pull_up(scl_pin);
+    gpio_put(sda_pin, false);
+    gpio_put(scl_pin, false);
+    i2c_bus_line(sda_pin, true);
+    i2c_bus_line(scl_pin, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+
+    // a cada pulso o escravo preso termina mais um bit do byte que estava mandando;
+    // em no máximo 9 (8 bits e o ACK) ele solta o SDA
+    for (int pulse = 0; pulse < 9 && !gpio_get(sda_pin); pulse++) {
+        i2c_bus_line(scl_pin, false);
+        sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+        i2c_bus_line(scl_pin, true);
+        sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+    }
+
+    // STOP: SDA sobe com o SCL em nível alto
+    i2c_bus_line(scl_pin, false);
+    i2c_bus_line(sda_pin, false);
+    sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+    i2c_bus_line(scl_pin, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+    i2c_bus_line(sda_pin, true);
+    sleep_us(I2C_BUS_CLEAR_HALF_PERIOD_US);
+
+    bool released = gpio_get(sda_pin);
+    gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+    gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+    return released;
+}
@@ -0,0 +1,49 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// i2c_inst_t do SDK; declarado aqui para os cabeçalhos dos drivers não puxarem o hardware/i2c.h
+struct i2c_inst;
+
+/*
+* Transferências I2C com tempo limite e recuperação do barramento
+* As funções *_blocking do SDK esperam para sempre: um escravo que trava
+* segurando o SDA (ex.: resetado no meio de um byte) prende o quadro inteiro.
+* Aqui cada transferência tem um limite proporcional ao tamanho e ao clock, e
+* cada dispositivo conta os próprios erros. Depois de algumas falhas seguidas
+* o driver limpa o barramento (até 9 pulsos de clock e um STOP, o que faz o
+* escravo terminar o byte e soltar o SDA) e reconfigura o dispositivo.
+*/
+
+// falhas seguidas antes de tentar a recuperação, e o intervalo mínimo entre duas
+#define I2C_BUS_RECOVERY_THRESHOLD 3
+#define I2C_BUS_RECOVERY_INTERVAL_US 100000
+
+typedef struct {
+    uint32_t errors;          // transferências que falharam (NACK ou tempo esgotado)
+    uint32_t timeouts;        // quantas dessas por tempo esgotado
+    uint32_t recoveries;      // barramento limpo e dispositivo reconfigurado
+    uint32_t consecutive;     // falhas seguidas desde a última transferência certa
+    uint32_t last_recovery_us;
+} i2c_bus_stats_t;
+
+// Escrita e leitura com tempo limite; retornam se todos os bytes passaram e contam as falhas
+bool i2c_bus_write(struct i2c_inst *i2c, uint8_t address, const uint8_t *src, size_t length, bool nostop,
+                   uint32_t baudrate, i2c_bus_stats_t *stats);
+bool i2c_bus_read(struct i2c_inst *i2c, uint8_t address, uint8_t *dst, size_t length, bool nostop,
+                  uint32_t baudrate, i2c_bus_stats_t *stats);
+
+// Se já houve falhas seguidas suficientes (e a última tentativa não foi agora há pouco)
+bool i2c_bus_needs_recovery(const i2c_bus_stats_t *stats);
+
+// Limpa o barramento com os pinos como GPIO (o periférico precisa estar desligado)
+// e os devolve ao I2C; retorna se o SDA ficou livre
+bool i2c_bus_clear(unsigned int sda_pin, unsigned int scl_pin);
+
+// Registra uma recuperação (feita pelo driver, que sabe reconfigurar o dispositivo)
+void i2c_bus_recovered(i2c_bus_stats_t *stats);
+
+#endif
@@ -0,0 +1,150 @@
+#include "joystick.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+#define JOYSTICK_RING_BYTES (JOYSTICK_RING_SAMPLES * sizeof(uint16_t))
+#define JOYSTICK_RING_BITS  7 // log2(JOYSTICK_RING_BYTES)
+
+// clock do ADC é 48 MHz e cada conversão leva 96 ciclos
+#define JOYSTICK_ADC_CLOCK_HZ 48000000
+
+// meia excursão inicial assumida antes de observar os extremos reais
+#define JOYSTICK_MIN_SPAN 1500
+
+_Static_assert((1u << JOYSTICK_RING_BITS) == JOYSTICK_RING_BYTES, "JOYSTICK_RING_BITS não confere com o tamanho do buffer");
+
+// o modo ring do DMA exige o buffer alinhado ao próprio tamanho
+static uint16_t joystick_ring[JOYSTICK_RING_SAMPLES] __attribute__((aligned(JOYSTICK_RING_BYTES)));
+
+// (re)inicia a captura contínua: o round-robin começa sempre no canal 0,
+// então índices pares do buffer são do canal 0 (Y) e ímpares do canal 1 (X)
+static void joystick_start_capture(joystick_t *joystick) {
+    adc_run(false);
+    dma_channel_abort(joystick->dma_channel);
+    adc_fifo_drain();
+
+    dma_channel_config config = dma_channel_get_default_config(joystick->dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_read_increment(&config, false);
+    channel_config_set_write_increment(&config, true);
+    channel_config_set_dreq(&config, DREQ_ADC);
+    // o endereço de escrita dá a volta no buffer sozinho
+    channel_config_set_ring(&config, true, JOYSTICK_RING_BITS);
+
+    // contagem máxima: a 2 kHz leva semanas para acabar, e joystick_read reinicia se acabar
+    dma_channel_configure(joystick->dma_channel, &config, joystick_ring, &adc_hw->fifo, 0xFFFFFFFFu, true);
+
+    adc_select_input(JOYSTICK_Y_CHANNEL);
+    adc_run(true);
+}
+
+bool joystick_init(joystick_t *joystick) {
+    if (joystick->initialized) return true;
+
+    adc_init();
+    adc_gpio_init(JOYSTICK_X_PIN);
+    adc_gpio_init(JOYSTICK_Y_PIN);
+
+    adc_set_round_robin((1u << JOYSTICK_X_CHANNEL) | (1u << JOYSTICK_Y_CHANNEL));
+    // fifo habilitado, gerando DREQ a cada amostra, sem bit de erro e sem reduzir para 8 bits
+    adc_fifo_setup(true, true, 1, false, false);
+    adc_set_clkdiv((float)JOYSTICK_ADC_CLOCK_HZ / JOYSTICK_SAMPLE_RATE_HZ - 1.0f);
+
+    int channel = dma_claim_unused_channel(false);
+    if (channel < 0) return false;
+    joystick->dma_channel = channel;
+
+    for (int i = 0; i < JOYSTICK_RING_SAMPLES; i++) {
+        joystick_ring[i] = 2048;
+    }
+    joystick_start_capture(joystick);
+
+    // espera o buffer encher antes de medir o centro
+    sleep_us((uint64_t)JOYSTICK_RING_SAMPLES * 1000000 / JOYSTICK_SAMPLE_RATE_HZ + 1000);
+
+    joystick->initialized = true;
+    joystick_calibrate_center(joystick);
+    return true;
+}
+
+void joystick_shutdown(joystick_t *joystick) {
+    if (!joystick->initialized) return;
+
+    adc_run(false);
+    dma_channel_abort(joystick->dma_channel);
+    dma_channel_unclaim(joystick->dma_channel);
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_set_round_robin(0);
+    adc_fifo_drain();
+
+    joystick->initialized = false;
+}
+
+void joystick_read_raw(joystick_t *joystick, uint16_t *x, uint16_t *y) {
+    // se a contagem do DMA chegou ao fim, recomeça a captura
+    if (!dma_channel_is_busy(joystick->dma_channel)) {
+        joystick_start_capture(joystick);
+    }
+
+    uint32_t sum_x = 0, sum_y = 0;
+    for (int i = 0; i < JOYSTICK_RING_SAMPLES; i += 2) {
+        sum_y += joystick_ring[i];
+        sum_x += joystick_ring[i + 1];
+    }
+
+    *x = (uint16_t)(sum_x / (JOYSTICK_RING_SAMPLES / 2));
+    *y = (uint16_t)(sum_y / (JOYSTICK_RING_SAMPLES / 2));
+}
+
+void joystick_calibrate_center(joystick_t *joystick) {
+    joystick_read_raw(joystick, &joystick->center_x, &joystick->center_y);
+
+    joystick->min_x = joystick->center_x > JOYSTICK_MIN_SPAN ? joystick->center_x - JOYSTICK_MIN_SPAN : 0;
+    joystick->max_x = joystick->center_x + JOYSTICK_MIN_SPAN;
+    joystick->min_y = joystick->center_y > JOYSTICK_MIN_SPAN ? joystick->center_y - JOYSTICK_MIN_SPAN : 0;
+    joystick->max_y = joystick->center_y + JOYSTICK_MIN_SPAN;
+
+    joystick->filtered_x = 0;
+    joystick->filtered_y = 0;
+}
+
+// converte uma leitura crua para ±JOYSTICK_FULL_SCALE, ampliando os extremos conhecidos
+static int32_t joystick_normalize(uint16_t raw, uint16_t center, uint16_t *min, uint16_t *max) {
+    if (raw < *min) *min = raw;
+    if (raw > *max) *max = raw;
+
+    int32_t offset = (int32_t)raw - center;
+    int32_t span = offset > 0 ? *max - center : center - *min;
+
+    if (offset > JOYSTICK_DEAD_ZONE) {
+        offset -= JOYSTICK_DEAD_ZONE;
+    } else if (offset < -JOYSTICK_DEAD_ZONE) {
+        offset += JOYSTICK_DEAD_ZONE;
+    } else {
+        return 0;
+    }
+
+    span -= JOYSTICK_DEAD_ZONE;
+    if (span <= 0) return 0;
+
+    int32_t value = offset * JOYSTICK_FULL_SCALE / span;
+    if (value > JOYSTICK_FULL_SCALE) value = JOYSTICK_FULL_SCALE;
+    if (value < -JOYSTICK_FULL_SCALE) value = -JOYSTICK_FULL_SCALE;
+    return value;
+}
+
+void joystick_read(joystick_t *joystick, int16_t *x, int16_t *y) {
+    uint16_t raw_x, raw_y;
+    joystick_read_raw(joystick, &raw_x, &raw_y);
+
+    int32_t value_x = joystick_normalize(raw_x, joystick->center_x, &joystick->min_x, &joystick->max_x);
+    int32_t value_y = joystick_normalize(raw_y, joystick->center_y, &joystick->min_y, &joystick->max_y);
+
+    // passa-baixa de primeira ordem só com soma e shift
+    joystick->filtered_x += (value_x - joystick->filtered_x) >> JOYSTICK_FILTER_SHIFT;
+    joystick->filtered_y += (value_y - joystick->filtered_y) >> JOYSTICK_FILTER_SHIFT;
+
+    *x = (int16_t)joystick->filtered_x;
+    *y = (int16_t)joystick->filtered_y;
+}
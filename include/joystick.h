@@ -0,0 +1,58 @@
+#ifndef JOYSTICK_H
+#define JOYSTICK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Joystick analógico lido pelo ADC sem custo de CPU por amostra
+* O ADC roda livre alternando entre os canais X e Y (round-robin) e o DMA
+* copia cada conversão para um buffer circular. A leitura só faz a média das
+* últimas amostras, aplica a calibração, a zona morta e um filtro passa-baixa.
+*/
+
+#define JOYSTICK_X_PIN     27  // ADC1
+#define JOYSTICK_Y_PIN     26  // ADC0
+#define JOYSTICK_X_CHANNEL 1
+#define JOYSTICK_Y_CHANNEL 0
+
+// taxa total de conversões (as duas entradas dividem essa taxa)
+#define JOYSTICK_SAMPLE_RATE_HZ 2000
+
+// amostras no buffer circular (metade de cada canal); potência de 2
+#define JOYSTICK_RING_SAMPLES 64
+
+// zona morta em torno do centro, em LSB do ADC (12 bits)
+#define JOYSTICK_DEAD_ZONE 120
+
+// peso das leituras anteriores no filtro: 2^-shift da nova leitura entra por vez
+#define JOYSTICK_FILTER_SHIFT 2
+
+// valor de saída na deflexão máxima (mesma escala de 1g no acelerômetro em ±2g)
+#define JOYSTICK_FULL_SCALE (1 << 14)
+
+typedef struct {
+    int dma_channel;
+    uint16_t center_x;
+    uint16_t center_y;
+    uint16_t min_x, max_x;   // extremos observados, para normalizar cada lado
+    uint16_t min_y, max_y;
+    int32_t filtered_x;
+    int32_t filtered_y;
+    bool initialized;
+} joystick_t;
+
+// configura ADC e DMA e calibra o centro com a alavanca solta
+bool joystick_init(joystick_t *joystick);
+void joystick_shutdown(joystick_t *joystick);
+
+// refaz a calibração do centro com a posição atual
+void joystick_calibrate_center(joystick_t *joystick);
+
+// média crua das amostras no buffer (0..4095)
+void joystick_read_raw(joystick_t *joystick, uint16_t *x, uint16_t *y);
+
+// posição normalizada em ±JOYSTICK_FULL_SCALE, com zona morta e filtro
+void joystick_read(joystick_t *joystick, int16_t *x, int16_t *y);
+
+#endif
@@ -1,18 +1,25 @@
 #include "mpu6050.h"
 #include "hardware/i2c.h"
+#include "i2c_bus.h"
 #include "pico/stdlib.h"
 #include <math.h>
 
 // Funções estáticas para comunicação I2C
-static void mpu6050_i2c_init();
+static void mpu6050_i2c_init(uint32_t baudrate);
 static bool mpu6050_write_register(uint8_t reg, uint8_t value);
 static bool mpu6050_read_register(uint8_t reg, uint8_t *value);
 static bool mpu6050_read_registers(uint8_t reg, uint8_t *buffer, size_t len);
+static bool mpu6050_write_register16(uint8_t reg, int16_t value);
+static bool mpu6050_write_offset_registers(mpu6050_t *mpu, const mpu6050_offsets_t *offsets);
+
+// Erros do barramento do sensor e o clock em uso (para o tempo limite das transferências)
+static i2c_bus_stats_t mpu6050_bus;
+static uint32_t mpu6050_baudrate;
 
 // Inicializa a comunicação I2C para o MPU6050
-static void mpu6050_i2c_init() {
-    // Usa 400kHz para comunicação rápida (MPU6050 suporta até 400kHz)
-    i2c_init(MPU_I2C_PORT, 400 * 1000);
+static void mpu6050_i2c_init(uint32_t baudrate) {
+    // Por padrão 400kHz para comunicação rápida (MPU6050 suporta até 400kHz)
+    mpu6050_baudrate = i2c_init(MPU_I2C_PORT, baudrate);
     gpio_set_function(MPU_SDA_PIN, GPIO_FUNC_I2C);
     gpio_set_function(MPU_SCL_PIN, GPIO_FUNC_I2C);
     
@@ -24,37 +31,71 @@ static void mpu6050_i2c_init() {
 // Escreve um valor em um registrador do MPU6050
 static bool mpu6050_write_register(uint8_t reg, uint8_t value) {
     uint8_t data[] = {reg, value};
-    int result = i2c_write_blocking(MPU_I2C_PORT, MPU6050_ADDRESS, data, 2, false);
-    return result == 2;
+    return i2c_bus_write(MPU_I2C_PORT, MPU6050_ADDRESS, data, 2, false, mpu6050_baudrate, &mpu6050_bus);
 }
 
 // Lê um valor de um registrador do MPU6050
 static bool mpu6050_read_register(uint8_t reg, uint8_t *value) {
     // Primeiro envia o endereço do registrador
-    int result = i2c_write_blocking(MPU_I2C_PORT, MPU6050_ADDRESS, &reg, 1, true);
-    if (result != 1) return false;
+    if (!i2c_bus_write(MPU_I2C_PORT, MPU6050_ADDRESS, &reg, 1, true, mpu6050_baudrate, &mpu6050_bus)) return false;
     
     // Depois lê o valor
-    result = i2c_read_blocking(MPU_I2C_PORT, MPU6050_ADDRESS, value, 1, false);
-    return result == 1;
+    return i2c_bus_read(MPU_I2C_PORT, MPU6050_ADDRESS, value, 1, false, mpu6050_baudrate, &mpu6050_bus);
 }
 
 // Lê múltiplos registradores sequenciais
 static bool mpu6050_read_registers(uint8_t reg, uint8_t *buffer, size_t len) {
     // Primeiro envia o endereço do registrador inicial
-    int result = i2c_write_blocking(MPU_I2C_PORT, MPU6050_ADDRESS, &reg, 1, true);
-    if (result != 1) return false;
+    if (!i2c_bus_write(MPU_I2C_PORT, MPU6050_ADDRESS, &reg, 1, true, mpu6050_baudrate, &mpu6050_bus)) return false;
     
     // Depois lê os dados
-    result = i2c_read_blocking(MPU_I2C_PORT, MPU6050_ADDRESS, buffer, len, false);
-    return result == (int)len;
+    return i2c_bus_read(MPU_I2C_PORT, MPU6050_ADDRESS, buffer, len, false, mpu6050_baudrate, &mpu6050_bus);
+}
+
+// Escreve um valor de 16 bits (big-endian) em dois registradores consecutivos
+static bool mpu6050_write_register16(uint8_t reg, int16_t value) {
+    uint8_t data[] = {reg, (uint8_t)((uint16_t)value >> 8), (uint8_t)value};
+    return i2c_bus_write(MPU_I2C_PORT, MPU6050_ADDRESS, data, 3, false, mpu6050_baudrate, &mpu6050_bus);
+}
+
+// Converte os offsets (na escala atual) para as unidades dos registradores de offset
+// e grava no sensor; offsets zerados restauram os valores de fábrica
+static bool mpu6050_write_offset_registers(mpu6050_t *mpu, const mpu6050_offsets_t *offsets) {
+    // acelerômetro: ±2g tem 8x mais LSB/g que os ±16g do registrador
+    int accel_shift = MPU6050_ACCEL_SCALE_16G - mpu->accel_scale;
+    int16_t accel[3] = {offsets->accel_x_offset, offsets->accel_y_offset, offsets->accel_z_offset};
+    static const uint8_t accel_regs[3] = {MPU6050_REG_XA_OFFS_H, MPU6050_REG_YA_OFFS_H, MPU6050_REG_ZA_OFFS_H};
+
+    for (int i = 0; i < 3; i++) {
+        int32_t correction = accel_shift > 0 ? (accel[i] + (1 << (accel_shift - 1))) >> accel_shift : accel[i];
+        int32_t value = mpu->accel_factory_trim[i] - correction;
+        // mantém o bit de compensação de temperatura de fábrica
+        value = (value & ~1) | (mpu->accel_factory_trim[i] & 1);
+        if (!mpu6050_write_register16(accel_regs[i], (int16_t)value)) return false;
+    }
+
+    // giroscópio: registrador em ±1000 dps, somado (por isso o sinal negativo)
+    int gyro_shift = MPU6050_GYRO_SCALE_1000DPS - mpu->gyro_scale;
+    int16_t gyro[3] = {offsets->gyro_x_offset, offsets->gyro_y_offset, offsets->gyro_z_offset};
+    static const uint8_t gyro_regs[3] = {MPU6050_REG_XG_OFFS_USRH, MPU6050_REG_YG_OFFS_USRH, MPU6050_REG_ZG_OFFS_USRH};
+
+    for (int i = 0; i < 3; i++) {
+        int32_t correction;
+        if (gyro_shift > 0) {
+            correction = (gyro[i] + (1 << (gyro_shift - 1))) >> gyro_shift;
+        } else {
+            correction = (int32_t)gyro[i] << -gyro_shift;
+        }
+        if (!mpu6050_write_register16(gyro_regs[i], (int16_t)-correction)) return false;
+    }
+    return true;
 }
 
 // Inicializa o MPU6050
 bool mpu6050_init(mpu6050_t *mpu) {
     if (mpu->initialized) return true;
     
-    mpu6050_i2c_init();
+    mpu6050_i2c_init(mpu->baudrate ? mpu->baudrate : MPU6050_I2C_BAUDRATE);
     
     // Sai do modo sleep e reseta o dispositivo
     if (!mpu6050_write_register(MPU6050_REG_PWR_MGMT_1, 0x80)) return false;
@@ -77,6 +118,14 @@ bool mpu6050_init(mpu6050_t *mpu) {
     // Configura filtro passa-baixa para reduzir ruído
     if (!mpu6050_set_dlpf(mpu, MPU6050_DLPF_44HZ)) return false;
     
+    // Guarda os offsets de fábrica do acelerômetro (restaurados pelo reset acima)
+    uint8_t trim[6];
+    if (!mpu6050_read_registers(MPU6050_REG_XA_OFFS_H, trim, 6)) return false;
+    for (int i = 0; i < 3; i++) {
+        mpu->accel_factory_trim[i] = (int16_t)((trim[2 * i] << 8) | trim[2 * i + 1]);
+    }
+    mpu->hw_offsets = false;
+
     // Zera os offsets
     mpu->offsets.accel_x_offset = 0;
     mpu->offsets.accel_y_offset = 0;
@@ -98,6 +147,50 @@ bool mpu6050_test_connection(mpu6050_t *mpu) {
     return (who_am_i == 0x68 || who_am_i == 0x70);
 }
 
+// Troca o clock do barramento do sensor
+uint32_t mpu6050_set_baudrate(mpu6050_t *mpu, uint32_t baudrate) {
+    mpu->baudrate = baudrate;
+    mpu6050_baudrate = i2c_set_baudrate(MPU_I2C_PORT, baudrate);
+    return mpu6050_baudrate;
+}
+
+// degraus do teste de clock e leituras conferidas em cada um
+static const uint32_t mpu6050_probe_steps[] = {400 * 1000, 600 * 1000, 800 * 1000, 1000 * 1000};
+#define MPU6050_PROBE_READS 16
+
+// lê de volta valores que não mudam sozinhos: o WHO_AM_I e os registradores de offset
+// do acelerômetro, comparados com a leitura feita no clock que já funcionava
+static bool mpu6050_probe_reads(mpu6050_t *mpu, const uint8_t *reference) {
+    for (int i = 0; i < MPU6050_PROBE_READS; i++) {
+        if (!mpu6050_test_connection(mpu)) return false;
+
+        uint8_t offsets[6];
+        if (!mpu6050_read_registers(MPU6050_REG_XA_OFFS_H, offsets, 6)) return false;
+        for (int j = 0; j < 6; j++) {
+            if (offsets[j] != reference[j]) return false;
+        }
+    }
+    return true;
+}
+
+uint32_t mpu6050_probe_baudrate(mpu6050_t *mpu, uint32_t max_baudrate) {
+    uint32_t good = mpu->baudrate ? mpu->baudrate : MPU6050_I2C_BAUDRATE;
+
+    uint8_t reference[6];
+    if (!mpu6050_read_registers(MPU6050_REG_XA_OFFS_H, reference, 6)) return mpu6050_set_baudrate(mpu, good);
+
+    for (size_t i = 0; i < sizeof(mpu6050_probe_steps) / sizeof(mpu6050_probe_steps[0]); i++) {
+        uint32_t step = mpu6050_probe_steps[i];
+        if (step <= good) continue;
+        if (step > max_baudrate) break;
+
+        mpu6050_set_baudrate(mpu, step);
+        if (!mpu6050_probe_reads(mpu, reference)) break;
+        good = step;
+    }
+    return mpu6050_set_baudrate(mpu, good);
+}
+
 // Desliga o MPU6050 e libera recursos
 void mpu6050_shutdown(mpu6050_t *mpu) {
     // Coloca o dispositivo em modo sleep
@@ -137,12 +230,37 @@ bool mpu6050_set_dlpf(mpu6050_t *mpu, mpu6050_dlpf_t dlpf) {
     return mpu6050_write_register(MPU6050_REG_CONFIG, dlpf);
 }
 
+// Depois de falhas seguidas: solta o barramento, reinicia o I2C e reconfigura o sensor
+// sem o reset (que leva 100 ms); se ele reiniciou sozinho por uma queda de tensão,
+// volta dormindo e com as escalas e offsets de fábrica
+static bool mpu6050_recover(mpu6050_t *mpu) {
+    i2c_deinit(MPU_I2C_PORT);
+    i2c_bus_clear(MPU_SDA_PIN, MPU_SCL_PIN);
+    mpu6050_i2c_init(mpu->baudrate ? mpu->baudrate : MPU6050_I2C_BAUDRATE);
+    i2c_bus_recovered(&mpu6050_bus);
+
+    return mpu6050_write_register(MPU6050_REG_PWR_MGMT_1, 0x00) &&
+           mpu6050_write_register(MPU6050_REG_PWR_MGMT_2, 0x00) &&
+           mpu6050_set_accel_scale(mpu, mpu->accel_scale) &&
+           mpu6050_set_gyro_scale(mpu, mpu->gyro_scale) &&
+           mpu6050_set_dlpf(mpu, MPU6050_DLPF_44HZ) &&
+           (!mpu->hw_offsets || mpu6050_write_offset_registers(mpu, &mpu->offsets));
+}
+
+i2c_bus_stats_t mpu6050_i2c_stats(void) {
+    return mpu6050_bus;
+}
+
 // Lê todos os dados brutos do sensor
 bool mpu6050_read_raw(mpu6050_t *mpu, mpu6050_raw_data_t *raw_data) {
     uint8_t buffer[14];
     
-    // Lê todos os registradores de dados de uma vez (0x3B a 0x48)
-    if (!mpu6050_read_registers(MPU6050_REG_ACCEL_XOUT_H, buffer, 14)) return false;
+    // Lê todos os registradores de dados de uma vez (0x3B a 0x48); uma leitura que
+    // falha não devolve nada (quem chama decide o que fazer sem um dado novo)
+    if (!mpu6050_read_registers(MPU6050_REG_ACCEL_XOUT_H, buffer, 14)) {
+        if (i2c_bus_needs_recovery(&mpu6050_bus)) mpu6050_recover(mpu);
+        return false;
+    }
     
     // Converte os dados (big-endian para little-endian)
     raw_data->accel_x = (int16_t)((buffer[0] << 8) | buffer[1]);
@@ -155,6 +273,9 @@ bool mpu6050_read_raw(mpu6050_t *mpu, mpu6050_raw_data_t *raw_data) {
     raw_data->gyro_y = (int16_t)((buffer[10] << 8) | buffer[11]);
     raw_data->gyro_z = (int16_t)((buffer[12] << 8) | buffer[13]);
     
+    // Com os offsets no silício a leitura já vem corrigida
+    if (mpu->hw_offsets) return true;
+
     // Aplica os offsets de calibração
     raw_data->accel_x -= mpu->offsets.accel_x_offset;
     raw_data->accel_y -= mpu->offsets.accel_y_offset;
@@ -192,9 +313,15 @@ bool mpu6050_read_accel_raw(mpu6050_t *mpu, int16_t *x, int16_t *y, int16_t *z)
     
     if (!mpu6050_read_registers(MPU6050_REG_ACCEL_XOUT_H, buffer, 6)) return false;
     
-    *x = (int16_t)((buffer[0] << 8) | buffer[1]) - mpu->offsets.accel_x_offset;
-    *y = (int16_t)((buffer[2] << 8) | buffer[3]) - mpu->offsets.accel_y_offset;
-    *z = (int16_t)((buffer[4] << 8) | buffer[5]) - mpu->offsets.accel_z_offset;
+    *x = (int16_t)((buffer[0] << 8) | buffer[1]);
+    *y = (int16_t)((buffer[2] << 8) | buffer[3]);
+    *z = (int16_t)((buffer[4] << 8) | buffer[5]);
+
+    if (!mpu->hw_offsets) {
+        *x -= mpu->offsets.accel_x_offset;
+        *y -= mpu->offsets.accel_y_offset;
+        *z -= mpu->offsets.accel_z_offset;
+    }
     
     return true;
 }
@@ -205,9 +332,15 @@ bool mpu6050_read_gyro_raw(mpu6050_t *mpu, int16_t *x, int16_t *y, int16_t *z) {
     
     if (!mpu6050_read_registers(MPU6050_REG_GYRO_XOUT_H, buffer, 6)) return false;
     
-    *x = (int16_t)((buffer[0] << 8) | buffer[1]) - mpu->offsets.gyro_x_offset;
-    *y = (int16_t)((buffer[2] << 8) | buffer[3]) - mpu->offsets.gyro_y_offset;
-    *z = (int16_t)((buffer[4] << 8) | buffer[5]) - mpu->offsets.gyro_z_offset;
+    *x = (int16_t)((buffer[0] << 8) | buffer[1]);
+    *y = (int16_t)((buffer[2] << 8) | buffer[3]);
+    *z = (int16_t)((buffer[4] << 8) | buffer[5]);
+
+    if (!mpu->hw_offsets) {
+        *x -= mpu->offsets.gyro_x_offset;
+        *y -= mpu->offsets.gyro_y_offset;
+        *z -= mpu->offsets.gyro_z_offset;
+    }
     
     return true;
 }
@@ -238,6 +371,7 @@ void mpu6050_calibrate(mpu6050_t *mpu, int samples) {
     mpu->offsets.gyro_x_offset = 0;
     mpu->offsets.gyro_y_offset = 0;
     mpu->offsets.gyro_z_offset = 0;
+    if (mpu->hw_offsets) mpu6050_write_offset_registers(mpu, &mpu->offsets);
     
     for (int i = 0; i < samples; i++) {
         mpu6050_raw_data_t raw;
@@ -259,11 +393,13 @@ void mpu6050_calibrate(mpu6050_t *mpu, int samples) {
     mpu->offsets.gyro_x_offset = gyro_x_sum / samples;
     mpu->offsets.gyro_y_offset = gyro_y_sum / samples;
     mpu->offsets.gyro_z_offset = gyro_z_sum / samples;
+    if (mpu->hw_offsets) mpu6050_write_offset_registers(mpu, &mpu->offsets);
 }
 
 // Define offsets manualmente
 void mpu6050_set_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets) {
     mpu->offsets = *offsets;
+    if (mpu->hw_offsets) mpu6050_write_offset_registers(mpu, &mpu->offsets);
 }
 
 // Obtém os offsets atuais
@@ -271,6 +407,17 @@ void mpu6050_get_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets) {
     *offsets = mpu->offsets;
 }
 
+// Liga/desliga a correção de offsets pelo próprio sensor
+// Ligada, os offsets atuais são gravados nos registradores e o driver deixa de
+// subtraí-los a cada leitura; desligada, os registradores voltam aos valores de fábrica
+bool mpu6050_set_hw_offsets(mpu6050_t *mpu, bool enable) {
+    static const mpu6050_offsets_t zero = {0};
+
+    if (!mpu6050_write_offset_registers(mpu, enable ? &mpu->offsets : &zero)) return false;
+    mpu->hw_offsets = enable;
+    return true;
+}
+
 // Retorna o fator de escala do acelerômetro
 float mpu6050_get_accel_sensitivity(mpu6050_accel_scale_t scale) {
     switch (scale) {
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "i2c_bus.h"
 
 /*
 * Biblioteca para controle do sensor MPU6050 (giroscópio + acelerômetro)
@@ -14,6 +15,15 @@
 #define MPU_SCL_PIN 1
 #define MPU_I2C_PORT i2c0
 
+// Clock do I2C: o MPU6050 é especificado até 400 kHz (Fast-mode); acima disso só
+// com teste (mpu6050_probe_baudrate) e resistores de pull-up externos
+#ifndef MPU6050_I2C_BAUDRATE
+#define MPU6050_I2C_BAUDRATE (400 * 1000)
+#endif
+#ifndef MPU6050_I2C_MAX_BAUDRATE
+#define MPU6050_I2C_MAX_BAUDRATE (400 * 1000)
+#endif
+
 // Endereço I2C do MPU6050 (pode ser 0x68 ou 0x69 dependendo do pino AD0)
 #define MPU6050_ADDRESS 0x68
 
@@ -41,6 +51,17 @@
 #define MPU6050_REG_GYRO_ZOUT_H   0x47
 #define MPU6050_REG_GYRO_ZOUT_L   0x48
 
+// Registradores de offset aplicados pelo próprio sensor
+// acelerômetro: escala de ±16g (2048 LSB/g), o bit 0 do byte baixo guarda a
+// compensação de temperatura de fábrica e precisa ser preservado
+#define MPU6050_REG_XA_OFFS_H     0x06
+#define MPU6050_REG_YA_OFFS_H     0x08
+#define MPU6050_REG_ZA_OFFS_H     0x0A
+// giroscópio: escala de ±1000 dps (32.8 LSB/dps), valor somado à leitura
+#define MPU6050_REG_XG_OFFS_USRH  0x13
+#define MPU6050_REG_YG_OFFS_USRH  0x15
+#define MPU6050_REG_ZG_OFFS_USRH  0x17
+
 // Registrador de temperatura
 #define MPU6050_REG_TEMP_OUT_H    0x41
 #define MPU6050_REG_TEMP_OUT_L    0x42
@@ -112,6 +133,9 @@ typedef struct {
     float accel_scale_factor;
     float gyro_scale_factor;
     mpu6050_offsets_t offsets;
+    bool hw_offsets;                 // offsets aplicados no silício em vez de em software
+    int16_t accel_factory_trim[3];   // valores de fábrica dos registradores XA/YA/ZA_OFFS
+    uint32_t baudrate;               // clock do I2C pedido; 0 usa MPU6050_I2C_BAUDRATE
 } mpu6050_t;
 
 // Funções principais
@@ -119,6 +143,16 @@ bool mpu6050_init(mpu6050_t *mpu);
 bool mpu6050_test_connection(mpu6050_t *mpu);
 void mpu6050_shutdown(mpu6050_t *mpu);
 
+// Clock do barramento: a troca retorna o clock de fato obtido; o teste sobe em
+// degraus até max_baudrate enquanto as leituras de volta conferirem e fica no
+// último degrau que funcionou
+uint32_t mpu6050_set_baudrate(mpu6050_t *mpu, uint32_t baudrate);
+uint32_t mpu6050_probe_baudrate(mpu6050_t *mpu, uint32_t max_baudrate);
+
+// Erros do barramento do sensor: transferências que falharam, tempos esgotados e
+// recuperações (feitas por mpu6050_read_raw depois de algumas falhas seguidas)
+i2c_bus_stats_t mpu6050_i2c_stats(void);
+
 // Configuração do sensor
 bool mpu6050_set_accel_scale(mpu6050_t *mpu, mpu6050_accel_scale_t scale);
 bool mpu6050_set_gyro_scale(mpu6050_t *mpu, mpu6050_gyro_scale_t scale);
@@ -135,6 +169,7 @@ bool mpu6050_read_temperature_raw(mpu6050_t *mpu, int16_t *temp);
 void mpu6050_calibrate(mpu6050_t *mpu, int samples);
 void mpu6050_set_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets);
 void mpu6050_get_offsets(mpu6050_t *mpu, mpu6050_offsets_t *offsets);
+bool mpu6050_set_hw_offsets(mpu6050_t *mpu, bool enable);
 
 // Funções auxiliares
 float mpu6050_get_accel_sensitivity(mpu6050_accel_scale_t scale);
@@ -0,0 +1,114 @@
+#include "mpu6050_calib.h"
+#include <math.h>
+
+// Arredonda um float para int16 sem passar por lroundf
+static int16_t round_to_int16(float value) {
+    return (int16_t)(value >= 0 ? value + 0.5f : value - 0.5f);
+}
+
+// Zera o acumulador de um eixo
+void mpu6050_welford_reset(mpu6050_welford_t *w) {
+    w->count = 0;
+    w->mean = 0.0f;
+    w->m2 = 0.0f;
+}
+
+// Atualiza média e variância com uma nova amostra (Welford, numericamente estável)
+void mpu6050_welford_add(mpu6050_welford_t *w, float value) {
+    w->count++;
+    float delta = value - w->mean;
+    w->mean += delta / (float)w->count;
+    w->m2 += delta * (value - w->mean);
+}
+
+// Variância amostral acumulada
+float mpu6050_welford_variance(const mpu6050_welford_t *w) {
+    if (w->count < 2) return 0.0f;
+    return w->m2 / (float)(w->count - 1);
+}
+
+// Reinicia a calibração do zero
+void mpu6050_calib_init(mpu6050_calib_t *calib, int window) {
+    if (window <= 1) window = MPU6050_CALIB_WINDOW;
+
+    for (int i = 0; i < MPU6050_AXIS_COUNT; i++) {
+        mpu6050_welford_reset(&calib->axes[i]);
+    }
+    calib->window = (uint16_t)window;
+    calib->stationary_windows = 0;
+    calib->accel_calibrated = false;
+    calib->converged = false;
+}
+
+// Verifica se todos os eixos ficaram estáveis durante a janela
+static bool calib_window_is_stationary(const mpu6050_calib_t *calib) {
+    for (int i = MPU6050_AXIS_ACCEL_X; i <= MPU6050_AXIS_ACCEL_Z; i++) {
+        if (mpu6050_welford_variance(&calib->axes[i]) > MPU6050_CALIB_ACCEL_VAR_MAX) return false;
+    }
+    for (int i = MPU6050_AXIS_GYRO_X; i <= MPU6050_AXIS_GYRO_Z; i++) {
+        if (mpu6050_welford_variance(&calib->axes[i]) > MPU6050_CALIB_GYRO_VAR_MAX) return false;
+    }
+    return true;
+}
+
+// Incorpora a média residual da janela aos offsets do sensor
+static void calib_apply_window(mpu6050_calib_t *calib, mpu6050_t *mpu) {
+    // a primeira janela parada define os offsets, as seguintes só refinam
+    float alpha = calib->stationary_windows == 0 ? 1.0f : MPU6050_CALIB_ALPHA;
+    float one_g = mpu->accel_scale_factor;
+
+    mpu6050_offsets_t offsets;
+    mpu6050_get_offsets(mpu, &offsets);
+
+    offsets.gyro_x_offset += round_to_int16(alpha * calib->axes[MPU6050_AXIS_GYRO_X].mean);
+    offsets.gyro_y_offset += round_to_int16(alpha * calib->axes[MPU6050_AXIS_GYRO_Y].mean);
+    offsets.gyro_z_offset += round_to_int16(alpha * calib->axes[MPU6050_AXIS_GYRO_Z].mean);
+
+    // o acelerômetro só é corrigido com o sensor perto de nivelado (z apontando para 1g)
+    float accel_x = calib->axes[MPU6050_AXIS_ACCEL_X].mean;
+    float accel_y = calib->axes[MPU6050_AXIS_ACCEL_Y].mean;
+    float accel_z = calib->axes[MPU6050_AXIS_ACCEL_Z].mean - one_g;
+    float level_max = MPU6050_CALIB_ACCEL_LEVEL_MAX * one_g;
+
+    if (fabsf(accel_x) < level_max && fabsf(accel_y) < level_max && fabsf(accel_z) < level_max) {
+        float accel_alpha = calib->accel_calibrated ? alpha : 1.0f;
+        offsets.accel_x_offset += round_to_int16(accel_alpha * accel_x);
+        offsets.accel_y_offset += round_to_int16(accel_alpha * accel_y);
+        offsets.accel_z_offset += round_to_int16(accel_alpha * accel_z);
+        calib->accel_calibrated = true;
+    }
+
+    mpu6050_set_offsets(mpu, &offsets);
+}
+
+// Alimenta o calibrador com uma leitura já corrigida pelos offsets atuais
+bool mpu6050_calib_update(mpu6050_calib_t *calib, mpu6050_t *mpu, const mpu6050_raw_data_t *raw) {
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_ACCEL_X], raw->accel_x);
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_ACCEL_Y], raw->accel_y);
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_ACCEL_Z], raw->accel_z);
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_GYRO_X], raw->gyro_x);
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_GYRO_Y], raw->gyro_y);
+    mpu6050_welford_add(&calib->axes[MPU6050_AXIS_GYRO_Z], raw->gyro_z);
+
+    if (calib->axes[0].count < calib->window) return false;
+
+    bool updated = false;
+    if (calib_window_is_stationary(calib)) {
+        calib_apply_window(calib, mpu);
+        if (calib->stationary_windows < UINT16_MAX) calib->stationary_windows++;
+        if (calib->stationary_windows >= MPU6050_CALIB_CONVERGE_WINDOWS && calib->accel_calibrated) {
+            calib->converged = true;
+        }
+        updated = true;
+    }
+
+    for (int i = 0; i < MPU6050_AXIS_COUNT; i++) {
+        mpu6050_welford_reset(&calib->axes[i]);
+    }
+    return updated;
+}
+
+// Indica se já houve janelas paradas suficientes
+bool mpu6050_calib_is_converged(const mpu6050_calib_t *calib) {
+    return calib->converged;
+}
@@ -0,0 +1,71 @@
+#ifndef MPU6050_CALIB_H
+#define MPU6050_CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mpu6050.h"
+
+/*
+* Calibração incremental do MPU6050
+* Em vez de bloquear a inicialização lendo milhares de amostras, cada leitura
+* feita pelo jogo alimenta médias e variâncias móveis (algoritmo de Welford).
+* Ao fim de cada janela, se a variância de todos os eixos for baixa o sensor
+* está parado, e a média residual é incorporada aos offsets aos poucos.
+*/
+
+// Amostras por janela de avaliação
+#define MPU6050_CALIB_WINDOW          64
+
+// Variância máxima (LSB²) para considerar o sensor parado
+#define MPU6050_CALIB_GYRO_VAR_MAX    200.0f
+#define MPU6050_CALIB_ACCEL_VAR_MAX   4000.0f
+
+// Desvio máximo em relação à posição nivelada (fração de 1g) para corrigir o acelerômetro,
+// evitando que uma inclinação parada seja confundida com offset
+#define MPU6050_CALIB_ACCEL_LEVEL_MAX 0.1f
+
+// Peso de cada nova janela parada depois da primeira
+#define MPU6050_CALIB_ALPHA           0.25f
+
+// Janelas paradas necessárias para considerar a calibração convergida
+#define MPU6050_CALIB_CONVERGE_WINDOWS 4
+
+// Média e variância acumuladas de um eixo
+typedef struct {
+    uint32_t count;
+    float mean;
+    float m2;   // soma dos quadrados das diferenças para a média
+} mpu6050_welford_t;
+
+typedef enum {
+    MPU6050_AXIS_ACCEL_X = 0,
+    MPU6050_AXIS_ACCEL_Y,
+    MPU6050_AXIS_ACCEL_Z,
+    MPU6050_AXIS_GYRO_X,
+    MPU6050_AXIS_GYRO_Y,
+    MPU6050_AXIS_GYRO_Z,
+    MPU6050_AXIS_COUNT
+} mpu6050_axis_t;
+
+// Estado do calibrador incremental
+typedef struct {
+    mpu6050_welford_t axes[MPU6050_AXIS_COUNT];
+    uint16_t window;
+    uint16_t stationary_windows;
+    bool accel_calibrated;
+    bool converged;
+} mpu6050_calib_t;
+
+void mpu6050_welford_reset(mpu6050_welford_t *w);
+void mpu6050_welford_add(mpu6050_welford_t *w, float value);
+float mpu6050_welford_variance(const mpu6050_welford_t *w);
+
+// Reinicia a calibração (window <= 0 usa MPU6050_CALIB_WINDOW)
+void mpu6050_calib_init(mpu6050_calib_t *calib, int window);
+
+// Alimenta uma leitura de mpu6050_read_raw; retorna true se os offsets do sensor mudaram
+bool mpu6050_calib_update(mpu6050_calib_t *calib, mpu6050_t *mpu, const mpu6050_raw_data_t *raw);
+
+bool mpu6050_calib_is_converged(const mpu6050_calib_t *calib);
+
+#endif
@@ -0,0 +1,57 @@
+#include "occupancy.h"
+#include <string.h>
+
+bool occupancy_init(occupancy_map_t *map, uint32_t *words, size_t word_count,
+                    int width, int height, int cell_shift, bool outside) {
+    int row_words = OCCUPANCY_ROW_WORDS(width);
+    if (width <= 0 || height <= 0 || width > 32 * 32) return false;
+    if ((size_t)row_words * (size_t)height > word_count) return false;
+
+    map->words = words;
+    map->width = width;
+    map->height = height;
+    map->row_shift = 0;
+    while ((1 << map->row_shift) < row_words) map->row_shift++;
+    map->cell_shift = (uint8_t)cell_shift;
+    map->outside = outside;
+
+    occupancy_clear(map);
+    return true;
+}
+
+void occupancy_clear(occupancy_map_t *map) {
+    memset(map->words, 0, ((size_t)map->height << map->row_shift) * sizeof(uint32_t));
+}
+
+void occupancy_set(occupancy_map_t *map, int x, int y, bool value) {
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height) return;
+
+    uint32_t *word = &map->words[((unsigned)y << map->row_shift) + ((unsigned)x >> 5)];
+    uint32_t mask = 1u << (x & 31);
+    if (value) {
+        *word |= mask;
+    } else {
+        *word &= ~mask;
+    }
+}
+
+void occupancy_from_cells(occupancy_map_t *map, const uint8_t *cells, uint8_t value, int upscale_shift) {
+    int cells_width = map->width >> upscale_shift;
+
+    for (int y = 0; y < map->height; y++) {
+        const uint8_t *row = &cells[(y >> upscale_shift) * cells_width];
+        for (int x = 0; x < map->width; x++) {
+            occupancy_set(map, x, y, row[x >> upscale_shift] == value);
+        }
+    }
+}
+
+void occupancy_from_page_buffer(occupancy_map_t *map, const uint8_t *buffer) {
+    for (int y = 0; y < map->height; y++) {
+        const uint8_t *page = &buffer[(y >> 3) * map->width];
+        uint8_t bit = 1u << (y & 7);
+        for (int x = 0; x < map->width; x++) {
+            occupancy_set(map, x, y, page[x] & bit);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "physics.h"
+
+/*
+* Mapa de ocupação compactado em bits
+* Cada célula do nível vira um bit numa palavra de 32 bits. As linhas têm
+* um número de palavras potência de dois, então achar o bit de (x, y) é só
+* deslocamento e máscara: words[(y << row_shift) + (x >> 5)] >> (x & 31).
+* O mesmo formato serve para o labirinto por células (16x8 = 8 palavras) e
+* para um mapa por pixel com formas arbitrárias (128x64 = 1 KB).
+*/
+
+// palavras por linha arredondadas para potência de dois (largura até 1024 células)
+#define OCCUPANCY_ROW_WORDS(width) \
+    (((width) + 31) / 32 <= 1 ? 1 : ((width) + 31) / 32 <= 2 ? 2 : ((width) + 31) / 32 <= 4 ? 4 : \
+     ((width) + 31) / 32 <= 8 ? 8 : ((width) + 31) / 32 <= 16 ? 16 : 32)
+
+// tamanho do armazenamento necessário, em palavras
+#define OCCUPANCY_WORDS(width, height) (OCCUPANCY_ROW_WORDS(width) * (height))
+
+typedef struct {
+    uint32_t *words;
+    int width;           // em células
+    int height;
+    uint8_t row_shift;   // log2 das palavras por linha
+    uint8_t cell_shift;  // log2 do lado da célula em pixels (0 = mapa por pixel)
+    bool outside;        // valor devolvido fora do mapa
+} occupancy_map_t;
+
+// Prepara o mapa sobre o armazenamento fornecido (sem alocação) e zera todos os bits
+// Retorna false se o armazenamento for pequeno demais
+bool occupancy_init(occupancy_map_t *map, uint32_t *words, size_t word_count,
+                    int width, int height, int cell_shift, bool outside);
+
+void occupancy_clear(occupancy_map_t *map);
+void occupancy_set(occupancy_map_t *map, int x, int y, bool value);
+
+// Compila uma grade de bytes (largura do mapa >> upscale_shift colunas), marcando as
+// células iguais a value; com upscale_shift > 0 cada célula vira um bloco de 2^shift bits
+void occupancy_from_cells(occupancy_map_t *map, const uint8_t *cells, uint8_t value, int upscale_shift);
+
+// Compila um buffer no formato do SSD1306 (páginas de 8 linhas, um byte por coluna),
+// permitindo desenhar o nível com as primitivas do display
+void occupancy_from_page_buffer(occupancy_map_t *map, const uint8_t *buffer);
+
+// Retorna o bit da célula (x, y)
+static inline bool occupancy_test(const occupancy_map_t *map, int x, int y) {
+    // negativos viram valores enormes sem sinal: um único teste por eixo
+    if ((unsigned)x >= (unsigned)map->width || (unsigned)y >= (unsigned)map->height) return map->outside;
+    return (map->words[((unsigned)y << map->row_shift) + ((unsigned)x >> 5)] >> (x & 31)) & 1u;
+}
+
+// Retorna o bit da célula que contém o ponto (x, y) em pixels, em ponto fixo
+static inline bool occupancy_test_point(const occupancy_map_t *map, fix_t x, fix_t y) {
+    int shift = PHYSICS_FRAC_BITS + map->cell_shift;
+    return occupancy_test(map, x >> shift, y >> shift);
+}
+
+#endif
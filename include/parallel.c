@@ -0,0 +1,81 @@
+#include "parallel.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#include "hardware/sync.h"
+
+// tarefa publicada pelo núcleo 0; generation muda a cada tarefa nova
+static volatile struct {
+    parallel_fn fn;
+    void *context;
+    int begin;
+    int end;
+    uint32_t generation;
+    uint32_t done;
+} job;
+
+static bool worker_running = false;
+static int active_cores = 1;
+
+static void parallel_worker(void) {
+    // permite que o núcleo 0 pause este núcleo durante gravações na flash
+    flash_safe_execute_core_init();
+
+    uint32_t seen = 0;
+    while (true) {
+        while (job.generation == seen) {
+            __wfe();
+        }
+        __dmb();
+        seen = job.generation;
+
+        job.fn(job.context, job.begin, job.end);
+
+        __dmb();
+        job.done = seen;
+        __sev();
+    }
+}
+
+void parallel_init(void) {
+    if (worker_running) return;
+
+    job.generation = 0;
+    job.done = 0;
+    multicore_launch_core1(parallel_worker);
+    worker_running = true;
+    active_cores = 2;
+}
+
+void parallel_set_cores(int cores) {
+    active_cores = (cores >= 2 && worker_running) ? 2 : 1;
+}
+
+int parallel_cores(void) {
+    return active_cores;
+}
+
+void parallel_for(parallel_fn fn, void *context, int count) {
+    if (active_cores < 2 || count < 2) {
+        fn(context, 0, count);
+        return;
+    }
+
+    int half = count / 2;
+
+    job.fn = fn;
+    job.context = context;
+    job.begin = half;
+    job.end = count;
+    __dmb();
+    uint32_t generation = job.generation + 1;
+    job.generation = generation;
+    __sev();
+
+    fn(context, 0, half);
+
+    while (job.done != generation) {
+        __wfe();
+    }
+    __dmb();
+}
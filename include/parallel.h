@@ -0,0 +1,33 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Divisão de laços entre os dois núcleos do RP2040
+* O núcleo 1 fica dormindo (WFE) até receber uma tarefa; o núcleo 0 publica
+* a função e o intervalo, executa a primeira metade e espera o núcleo 1
+* terminar a segunda. Cada chamada é uma barreira completa, então fases que
+* dependem umas das outras (densidade -> pressão -> deslocamento) podem ser
+* encadeadas sem corrida.
+*
+* A sincronização usa memória compartilhada e SEV/WFE, não a FIFO entre
+* núcleos: a FIFO é usada pelo flash_safe_execute para pausar o núcleo 1
+* durante a gravação das configurações.
+*/
+
+// Processa os itens [begin, end)
+typedef void (*parallel_fn)(void *context, int begin, int end);
+
+// Inicia o núcleo 1 como trabalhador
+void parallel_init(void);
+
+// Usa 1 ou 2 núcleos nas próximas chamadas (útil para comparar no benchmark)
+void parallel_set_cores(int cores);
+int parallel_cores(void);
+
+// Executa fn sobre [0, count), dividindo entre os núcleos, e só retorna quando ambos terminarem
+void parallel_for(parallel_fn fn, void *context, int count);
+
+#endif
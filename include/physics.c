@@ -0,0 +1,53 @@
+#include "physics.h"
+#include <math.h>
+
+// com k ~16 passos por quadro de referência a gravidade por passo é 0.15 / k²;
+// em Q.8 ou Q.12 ela (e a velocidade que ela soma a cada passo) arredonda para zero
+_Static_assert(PHYSICS_FRAC_BITS >= 16, "a física em passo fixo precisa de pelo menos 16 bits fracionários");
+
+// Com k passos por quadro de referência e velocidade em pixels/passo:
+// - o ganho da gravidade cai com k² (uma vez pela velocidade, outra pela posição)
+// - o amortecimento por passo é a raiz k-ésima do amortecimento por quadro
+// - o ganho da gravidade por passo tem só ~36 LSB em Q.16: ele guarda
+//   PHYSICS_GAIN_BITS bits a mais, senão o erro dele já passa de 1%
+// A conta em float só acontece aqui, na configuração
+void physics_config_for_step(physics_config_t *config, uint32_t step_us) {
+    float k = (float)PHYSICS_REF_STEP_US / (float)step_us;
+
+    config->gravity = (fix_t)(PHYSICS_GRAVITY_SENSITIVITY / (k * k) * (float)(FIX_ONE << PHYSICS_GAIN_BITS) + 0.5f);
+    config->damping = FIX_FROM_FLOAT(powf(PHYSICS_DAMPING, 1.0f / k));
+    config->bounce = FIX_FROM_FLOAT(PHYSICS_BOUNCE_FACTOR);
+}
+
+// Coloca a bola parada na posição indicada
+void physics_ball_reset(physics_ball_t *ball, fix_t x, fix_t y) {
+    ball->x = x;
+    ball->y = y;
+    ball->vel_x = 0;
+    ball->vel_y = 0;
+}
+
+// raw / 2^shift em g, sem divisão
+fix_t physics_accel_from_raw(int16_t raw, uint8_t lsb_per_g_shift) {
+    if (lsb_per_g_shift >= PHYSICS_FRAC_BITS) {
+        return (fix_t)raw >> (lsb_per_g_shift - PHYSICS_FRAC_BITS);
+    }
+    return (fix_t)raw * ((fix_t)1 << (PHYSICS_FRAC_BITS - lsb_per_g_shift));
+}
+
+// produto arredondado para o mais próximo: a cada passo a velocidade muda só
+// alguns LSB, e o truncamento de fix_mul (sempre para baixo) vira uma deriva
+// que puxa a bola para a esquerda e para cima (tools/physics_reference_test.c)
+static inline fix_t physics_mul_round(fix_t a, fix_t b, int shift) {
+    return (fix_t)(((int64_t)a * b + ((int64_t)1 << (shift - 1))) >> shift);
+}
+
+// Aplica a inclinação e o amortecimento na velocidade, sem mover a bola
+void physics_ball_accelerate(physics_ball_t *ball, const physics_config_t *config,
+                             fix_t accel_x, fix_t accel_y) {
+    ball->vel_x += physics_mul_round(accel_x, config->gravity, PHYSICS_FRAC_BITS + PHYSICS_GAIN_BITS);
+    ball->vel_y += physics_mul_round(accel_y, config->gravity, PHYSICS_FRAC_BITS + PHYSICS_GAIN_BITS);
+
+    ball->vel_x = physics_mul_round(ball->vel_x, config->damping, PHYSICS_FRAC_BITS);
+    ball->vel_y = physics_mul_round(ball->vel_y, config->damping, PHYSICS_FRAC_BITS);
+}
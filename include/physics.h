@@ -0,0 +1,76 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Física da bola em ponto fixo
+* O RP2040 (Cortex-M0+) não tem FPU, então toda conta em float vira chamada
+* de rotina de software. Aqui posição, velocidade e constantes são inteiros
+* no formato Q(31 - PHYSICS_FRAC_BITS).PHYSICS_FRAC_BITS
+*/
+
+// Quantidade de bits fracionários (ex.: 16 -> Q15.16, 20 -> Q11.20); com o passo fixo
+// de 2 ms o ganho da gravidade por passo é ~0.0006, e abaixo de 16 bits ele e o
+// incremento de velocidade que ele produz somem no arredondamento (physics.c)
+#ifndef PHYSICS_FRAC_BITS
+#define PHYSICS_FRAC_BITS 16
+#endif
+
+// Constantes da simulação (mesmos valores da versão em float)
+#define PHYSICS_GRAVITY_SENSITIVITY 0.15f
+#define PHYSICS_DAMPING             0.95f
+#define PHYSICS_BOUNCE_FACTOR       0.6f
+
+// Duração do quadro do laço original (~10 ms de espera + ~23 ms de envio do display),
+// período para o qual as constantes acima foram ajustadas
+#define PHYSICS_REF_STEP_US 33000
+
+// Escala do acelerômetro em ±2g: 16384 LSB/g == 1 << 14
+#define PHYSICS_ACCEL_SHIFT_2G 14
+
+typedef int32_t fix_t;
+
+// bits fracionários extras do ganho da gravidade (aceleração em g até ±2 cabe no produto de 64 bits)
+#define PHYSICS_GAIN_BITS 8
+
+#define FIX_ONE            ((fix_t)1 << PHYSICS_FRAC_BITS)
+#define FIX_FROM_INT(i)    ((fix_t)(i) * FIX_ONE)
+#define FIX_TO_INT(f)      ((int)((f) >> PHYSICS_FRAC_BITS))
+// com constantes o compilador resolve a conversão em tempo de compilação
+#define FIX_FROM_FLOAT(f)  ((fix_t)((f) * (float)FIX_ONE + ((f) >= 0 ? 0.5f : -0.5f)))
+#define FIX_TO_FLOAT(f)    ((float)(f) / (float)FIX_ONE)
+
+// multiplicação em ponto fixo (produto intermediário em 64 bits)
+static inline fix_t fix_mul(fix_t a, fix_t b) {
+    return (fix_t)(((int64_t)a * b) >> PHYSICS_FRAC_BITS);
+}
+
+// Parâmetros da integração, já convertidos para ponto fixo
+typedef struct {
+    fix_t gravity;   // ganho aplicado à aceleração medida (com PHYSICS_GAIN_BITS bits a mais)
+    fix_t damping;   // fator multiplicado na velocidade a cada passo
+    fix_t bounce;    // fração da velocidade mantida após uma colisão
+} physics_config_t;
+
+// Estado da bola (posição em pixels e velocidade em pixels/passo)
+typedef struct {
+    fix_t x;
+    fix_t y;
+    fix_t vel_x;
+    fix_t vel_y;
+} physics_ball_t;
+
+// Reescala as constantes para passos de step_us, mantendo o mesmo comportamento por segundo
+void physics_config_for_step(physics_config_t *config, uint32_t step_us);
+void physics_ball_reset(physics_ball_t *ball, fix_t x, fix_t y);
+
+// Converte uma leitura bruta do acelerômetro em g (ponto fixo) usando apenas shift
+fix_t physics_accel_from_raw(int16_t raw, uint8_t lsb_per_g_shift);
+
+// Integra a aceleração e aplica amortecimento (o movimento fica a cargo de quem chama)
+void physics_ball_accelerate(physics_ball_t *ball, const physics_config_t *config,
+                             fix_t accel_x, fix_t accel_y);
+
+#endif
@@ -0,0 +1,138 @@
+#include "profiler.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILER_SYSTICK_MASK 0x00FFFFFFu
+
+static const char *const *zone_names;
+static int zone_count;
+static profiler_stats_t stats[PROFILER_MAX_ZONES];
+
+static profiler_sample_t ring[PROFILER_RING_SIZE];
+static uint32_t ring_head;   // total de medições já gravadas
+
+static uint32_t frame_number;
+static uint32_t frame_start;
+static bool frame_started;
+static uint32_t overhead_cycles;  // custo de um par profiler_now + profiler_record
+
+_Static_assert((PROFILER_RING_SIZE & (PROFILER_RING_SIZE - 1)) == 0, "o buffer circular precisa ser potência de 2");
+
+uint32_t profiler_now(void) {
+    return systick_hw->cvr;
+}
+
+static uint32_t profiler_elapsed(uint32_t start) {
+    return (start - systick_hw->cvr) & PROFILER_SYSTICK_MASK;
+}
+
+// índice do bit mais alto: balde do histograma
+static int profiler_bucket(uint32_t cycles) {
+    int bucket = 0;
+    while (cycles >>= 1) bucket++;
+    return bucket < PROFILER_BUCKETS ? bucket : PROFILER_BUCKETS - 1;
+}
+
+void profiler_reset(void) {
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < PROFILER_MAX_ZONES; i++) stats[i].min_cycles = UINT32_MAX;
+    ring_head = 0;
+}
+
+void profiler_record(int zone, uint32_t start) {
+    uint32_t cycles = profiler_elapsed(start);
+    if (zone < 0 || zone >= zone_count) return;
+    cycles = cycles > overhead_cycles ? cycles - overhead_cycles : 0;
+
+    profiler_stats_t *zone_stats = &stats[zone];
+    zone_stats->count++;
+    zone_stats->total_cycles += cycles;
+    if (cycles < zone_stats->min_cycles) zone_stats->min_cycles = cycles;
+    if (cycles > zone_stats->max_cycles) zone_stats->max_cycles = cycles;
+    zone_stats->histogram[profiler_bucket(cycles)]++;
+
+    profiler_sample_t *sample = &ring[ring_head++ & (PROFILER_RING_SIZE - 1)];
+    sample->frame = frame_number;
+    sample->cycles = cycles;
+    sample->zone = (uint8_t)zone;
+}
+
+void profiler_init(const char *const *names, int count) {
+    zone_names = names;
+    zone_count = count < PROFILER_MAX_ZONES ? count : PROFILER_MAX_ZONES;
+    frame_started = false;
+    frame_number = 0;
+
+    // contador livre no clock do processador
+    systick_hw->csr = 0;
+    systick_hw->rvr = PROFILER_SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5;
+
+    // custo da própria medição, descontado de cada zona
+    overhead_cycles = 0;
+    uint32_t start = profiler_now();
+    profiler_record(PROFILER_ZONE_FRAME, start);
+    overhead_cycles = profiler_elapsed(start);
+    profiler_reset();
+}
+
+void profiler_frame(void) {
+    if (frame_started) profiler_record(PROFILER_ZONE_FRAME, frame_start);
+    frame_start = profiler_now();
+    frame_started = true;
+    frame_number++;
+}
+
+const profiler_stats_t *profiler_stats(int zone) {
+    return zone >= 0 && zone < zone_count ? &stats[zone] : NULL;
+}
+
+static uint32_t profiler_cycles_to_us(uint64_t cycles) {
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    return (uint32_t)(cycles / (mhz ? mhz : 1));
+}
+
+void profiler_report(void) {
+    printf("zona            vezes   min us   med us   max us  histograma (2^k ciclos: vezes)\n");
+    for (int zone = 0; zone < zone_count; zone++) {
+        const profiler_stats_t *zone_stats = &stats[zone];
+        if (zone_stats->count == 0) continue;
+
+        printf("%-12s %8lu %8lu %8lu %8lu ", zone_names[zone], (unsigned long)zone_stats->count,
+               (unsigned long)profiler_cycles_to_us(zone_stats->min_cycles),
+               (unsigned long)profiler_cycles_to_us(zone_stats->total_cycles / zone_stats->count),
+               (unsigned long)profiler_cycles_to_us(zone_stats->max_cycles));
+        for (int bucket = 0; bucket < PROFILER_BUCKETS; bucket++) {
+            if (zone_stats->histogram[bucket]) {
+                printf(" %d:%lu", bucket, (unsigned long)zone_stats->histogram[bucket]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+void profiler_dump_ring(void) {
+    uint32_t count = ring_head < PROFILER_RING_SIZE ? ring_head : PROFILER_RING_SIZE;
+    printf("quadro  zona          ciclos\n");
+    for (uint32_t i = ring_head - count; i != ring_head; i++) {
+        const profiler_sample_t *sample = &ring[i & (PROFILER_RING_SIZE - 1)];
+        printf("%6lu  %-12s %8lu\n", (unsigned long)sample->frame, zone_names[sample->zone],
+               (unsigned long)sample->cycles);
+    }
+}
+
+void profiler_poll_command(void) {
+    int c = getchar_timeout_us(0);
+    if (c == 'p') {
+        profiler_report();
+    } else if (c == 't') {
+        profiler_dump_ring();
+    } else if (c == 'r') {
+        profiler_reset();
+        printf("perfil zerado\n");
+    }
+}
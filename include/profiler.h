@@ -0,0 +1,81 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Perfil do quadro por zonas, medido em ciclos pelo SysTick
+* Cada zona marcada com PROFILE_ZONE mede quantos ciclos o trecho levou e
+* acumula mínimo, média, máximo e um histograma em potências de 2. As últimas
+* medições ficam num buffer circular, para ver a sequência de um quadro.
+*
+* Pelo USB (stdio), uma tecla por vez:
+*   p  mostra a tabela das zonas     t  mostra as últimas medições
+*   r  zera as estatísticas
+*
+* Só existe com -DPROFILER: sem ele as macros somem e as zonas não custam nada.
+* O SysTick é de 24 bits (134 ms a 125 MHz), então zonas maiores que isso
+* saem erradas. Só o núcleo 0 deve registrar zonas.
+*/
+
+#define PROFILER_MAX_ZONES   16
+#define PROFILER_RING_SIZE   256   // potência de 2
+#define PROFILER_BUCKETS     24    // histograma: ciclos em [2^k, 2^(k+1))
+
+// zona 0 é sempre o quadro inteiro (de um PROFILE_FRAME ao seguinte)
+#define PROFILER_ZONE_FRAME 0
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t histogram[PROFILER_BUCKETS];
+} profiler_stats_t;
+
+typedef struct {
+    uint32_t frame;
+    uint32_t cycles;
+    uint8_t zone;
+} profiler_sample_t;
+
+// Configura o SysTick e registra os nomes das zonas (names[0] é o quadro)
+void profiler_init(const char *const *names, int count);
+
+// Contador do SysTick (decrescente, 24 bits)
+uint32_t profiler_now(void);
+
+// Registra uma medição da zona que começou em start (valor de profiler_now)
+void profiler_record(int zone, uint32_t start);
+
+// Fecha o quadro anterior (zona 0) e começa outro
+void profiler_frame(void);
+
+const profiler_stats_t *profiler_stats(int zone);
+void profiler_reset(void);
+
+// Tabela com mínimo/média/máximo em microssegundos e o histograma de cada zona
+void profiler_report(void);
+
+// Últimas medições do buffer circular, da mais antiga para a mais nova
+void profiler_dump_ring(void);
+
+// Atende os comandos do USB (não bloqueia)
+void profiler_poll_command(void);
+
+#ifdef PROFILER
+// PROFILE_ZONE(zona) comando;  ou  PROFILE_ZONE(zona) { ... }
+// (um break/return dentro do bloco pula a medição)
+#define PROFILE_ZONE(zone)                                                                        \
+    for (uint32_t profile_start_ = profiler_now(), profile_once_ = 1; profile_once_;              \
+         profiler_record((zone), profile_start_), profile_once_ = 0)
+#define PROFILE_FRAME() profiler_frame()
+#define PROFILE_POLL() profiler_poll_command()
+#else
+#define PROFILE_ZONE(zone)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_POLL() ((void)0)
+#endif
+
+#endif
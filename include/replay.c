@@ -0,0 +1,270 @@
+#include "replay.h"
+#include <string.h>
+
+// tipos de registro
+enum {
+    REPLAY_TAG_FRAME = 1,
+    REPLAY_TAG_TIME,
+    REPLAY_TAG_SENSOR,
+    REPLAY_TAG_SENSOR_FAIL,  // a leitura falhou (nenhum campo)
+    REPLAY_TAG_BUTTON,
+    REPLAY_TAG_STICK
+};
+
+// campos do sensor na ordem em que são gravados
+#define REPLAY_SENSOR_FIELDS 7
+
+static int16_t *replay_raw_field(mpu6050_raw_data_t *raw, int field) {
+    switch (field) {
+        case 0: return &raw->accel_x;
+        case 1: return &raw->accel_y;
+        case 2: return &raw->accel_z;
+        case 3: return &raw->gyro_x;
+        case 4: return &raw->gyro_y;
+        case 5: return &raw->gyro_z;
+        default: return &raw->temperature;
+    }
+}
+
+// zigzag: números pequenos com sinal viram varints curtos
+static inline uint32_t replay_zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t replay_unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1u);
+}
+
+// ---- escrita ----
+
+static void replay_write_byte(replay_t *replay, uint8_t value) {
+    if (replay->length < replay->capacity) {
+        replay->buffer[replay->length] = value;
+    }
+    replay->length++;
+}
+
+// 7 bits por byte, o bit mais alto indica que há continuação
+static void replay_write_varint(replay_t *replay, uint32_t value) {
+    while (value >= 0x80) {
+        replay_write_byte(replay, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    replay_write_byte(replay, (uint8_t)value);
+}
+
+// Só grava enquanto estiver no modo de gravação; se um registro não couber,
+// o fluxo volta para o fim do último quadro completo e a gravação termina
+static bool replay_can_write(const replay_t *replay) {
+    return replay->mode == REPLAY_MODE_RECORD && !replay->ended;
+}
+
+static void replay_check_overflow(replay_t *replay) {
+    if (replay->length > replay->capacity) {
+        replay->length = replay->frame_start;
+        replay->ended = true;
+    }
+}
+
+// ---- leitura ----
+
+static void replay_fail(replay_t *replay) {
+    replay->ended = true;
+    replay->desync = true;
+}
+
+static bool replay_read_byte(replay_t *replay, uint8_t *value) {
+    if (replay->position >= replay->length) {
+        replay_fail(replay);
+        return false;
+    }
+    *value = replay->data[replay->position++];
+    return true;
+}
+
+static uint32_t replay_read_varint(replay_t *replay) {
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte;
+        if (!replay_read_byte(replay, &byte)) return 0;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    replay_fail(replay);
+    return 0;
+}
+
+// Consome o próximo registro se ele for do tipo pedido
+static bool replay_take(replay_t *replay, uint8_t tag) {
+    if (replay->mode != REPLAY_MODE_PLAY || replay->ended) return false;
+    if (replay->position >= replay->length || replay->data[replay->position] != tag) return false;
+    replay->position++;
+    return true;
+}
+
+// Como replay_take, mas a ausência do registro é uma dessincronização
+static bool replay_expect(replay_t *replay, uint8_t tag) {
+    if (replay->mode != REPLAY_MODE_PLAY || replay->ended) return false;
+    if (replay_take(replay, tag)) return true;
+    replay_fail(replay);
+    return false;
+}
+
+// ---- interface ----
+
+static void replay_reset(replay_t *replay, replay_mode_t mode) {
+    memset(replay, 0, sizeof(*replay));
+    replay->mode = mode;
+}
+
+bool replay_record_start(replay_t *replay, uint8_t *buffer, uint32_t capacity, const replay_header_t *header) {
+    replay_reset(replay, REPLAY_MODE_RECORD);
+    if (capacity < sizeof(replay_header_t) + REPLAY_MAX_FRAME_BYTES) {
+        replay->ended = true;
+        return false;
+    }
+
+    replay->buffer = buffer;
+    replay->data = buffer;
+    replay->capacity = capacity;
+    replay->header = *header;
+    replay->header.magic = REPLAY_MAGIC;
+    replay->header.version = REPLAY_VERSION;
+    replay->header.size = sizeof(replay_header_t);
+
+    memcpy(buffer, &replay->header, sizeof(replay_header_t));
+    replay->length = sizeof(replay_header_t);
+    replay->frame_start = replay->length;
+    return true;
+}
+
+bool replay_play_start(replay_t *replay, const uint8_t *data, uint32_t length) {
+    replay_reset(replay, REPLAY_MODE_PLAY);
+    replay->ended = true;
+    if (length < sizeof(replay_header_t)) return false;
+
+    memcpy(&replay->header, data, sizeof(replay_header_t));
+    if (replay->header.magic != REPLAY_MAGIC || replay->header.version != REPLAY_VERSION ||
+        replay->header.size != sizeof(replay_header_t)) {
+        return false;
+    }
+
+    replay->data = data;
+    replay->length = length;
+    replay->position = sizeof(replay_header_t);
+    replay->ended = false;
+    return true;
+}
+
+bool replay_frame(replay_t *replay) {
+    if (replay->mode == REPLAY_MODE_RECORD) {
+        if (replay->ended) return false;
+        replay->frame_start = replay->length;
+        if (replay->capacity - replay->length < REPLAY_MAX_FRAME_BYTES) {
+            replay->ended = true;
+            return false;
+        }
+        replay_write_byte(replay, REPLAY_TAG_FRAME);
+        replay->frames++;
+        return true;
+    }
+
+    if (replay->mode != REPLAY_MODE_PLAY || replay->ended) return false;
+    if (replay->position >= replay->length) {
+        // fim normal do fluxo
+        replay->ended = true;
+        return false;
+    }
+    if (!replay_expect(replay, REPLAY_TAG_FRAME)) return false;
+    replay->frames++;
+    return true;
+}
+
+void replay_put_button(replay_t *replay, const button_event *event) {
+    if (!replay_can_write(replay)) return;
+    replay_write_byte(replay, REPLAY_TAG_BUTTON);
+    replay_write_byte(replay, (uint8_t)(event->button | (event->action << 4)));
+    // o evento aconteceu pouco antes do quadro: diferença pequena e quase sempre negativa
+    replay_write_varint(replay, replay_zigzag((int32_t)(event->time_us - replay->last_time_us)));
+    replay_check_overflow(replay);
+}
+
+bool replay_get_button(replay_t *replay, button_event *event) {
+    if (!replay_take(replay, REPLAY_TAG_BUTTON)) return false;
+
+    uint8_t packed;
+    if (!replay_read_byte(replay, &packed)) return false;
+    event->button = (button_id)(packed & 0x0F);
+    event->action = (button_action)(packed >> 4);
+    event->time_us = replay->last_time_us + (uint32_t)replay_unzigzag(replay_read_varint(replay));
+    return !replay->ended;
+}
+
+void replay_put_time(replay_t *replay, uint32_t now_us) {
+    if (!replay_can_write(replay)) return;
+    replay_write_byte(replay, REPLAY_TAG_TIME);
+    replay_write_varint(replay, now_us - replay->last_time_us);
+    replay->last_time_us = now_us;
+    replay_check_overflow(replay);
+}
+
+uint32_t replay_get_time(replay_t *replay) {
+    if (replay_expect(replay, REPLAY_TAG_TIME)) {
+        replay->last_time_us += replay_read_varint(replay);
+    }
+    return replay->last_time_us;
+}
+
+void replay_put_sensor(replay_t *replay, bool ok, const mpu6050_raw_data_t *raw) {
+    if (!replay_can_write(replay)) return;
+    if (!ok) {
+        replay_write_byte(replay, REPLAY_TAG_SENSOR_FAIL);
+        replay_check_overflow(replay);
+        return;
+    }
+
+    mpu6050_raw_data_t sample = *raw;
+    replay_write_byte(replay, REPLAY_TAG_SENSOR);
+    for (int field = 0; field < REPLAY_SENSOR_FIELDS; field++) {
+        int16_t value = *replay_raw_field(&sample, field);
+        int16_t *last = replay_raw_field(&replay->last_raw, field);
+        replay_write_varint(replay, replay_zigzag(value - *last));
+        *last = value;
+    }
+    replay_check_overflow(replay);
+}
+
+bool replay_get_sensor(replay_t *replay, mpu6050_raw_data_t *raw) {
+    if (replay_take(replay, REPLAY_TAG_SENSOR_FAIL)) return false;
+    if (!replay_expect(replay, REPLAY_TAG_SENSOR)) return false;
+
+    for (int field = 0; field < REPLAY_SENSOR_FIELDS; field++) {
+        int16_t *last = replay_raw_field(&replay->last_raw, field);
+        *last = (int16_t)(*last + replay_unzigzag(replay_read_varint(replay)));
+    }
+    *raw = replay->last_raw;
+    return !replay->ended;
+}
+
+void replay_put_stick(replay_t *replay, int16_t x, int16_t y) {
+    if (!replay_can_write(replay)) return;
+    replay_write_byte(replay, REPLAY_TAG_STICK);
+    replay_write_varint(replay, replay_zigzag(x));
+    replay_write_varint(replay, replay_zigzag(y));
+    replay_check_overflow(replay);
+}
+
+void replay_get_stick(replay_t *replay, int16_t *x, int16_t *y) {
+    *x = 0;
+    *y = 0;
+    if (!replay_expect(replay, REPLAY_TAG_STICK)) return;
+    *x = (int16_t)replay_unzigzag(replay_read_varint(replay));
+    *y = (int16_t)replay_unzigzag(replay_read_varint(replay));
+}
+
+void replay_stop(replay_t *replay) {
+    if (replay->mode == REPLAY_MODE_RECORD && !replay->ended) {
+        // o quadro em andamento fica: o que foi gravado dele já foi aplicado ao jogo
+        replay->ended = true;
+    }
+}
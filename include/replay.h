@@ -0,0 +1,98 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mpu6050.h"
+#include "button.h"
+
+/*
+* Gravação e reprodução das entradas do jogo
+* Tudo o que vem de fora da simulação passa por aqui: o instante de cada quadro,
+* as leituras cruas do sensor, os eventos dos botões e o joystick. Gravando
+* essas entradas na ordem em que o laço principal as consome, a reprodução
+* alimenta o mesmo laço com os mesmos valores e o resultado é idêntico bit a
+* bit (no dispositivo ou numa compilação para o PC).
+*
+* O fluxo é um cabeçalho seguido de registros de um byte de tipo e campos em
+* varint: o tempo é gravado como diferença para o quadro anterior e cada eixo
+* do sensor como diferença para a leitura anterior, então um quadro típico
+* ocupa uns 10 bytes.
+*
+* Este módulo só monta e lê o fluxo em memória; onde ele é guardado (flash ou
+* USB) fica em replay_storage.c.
+*/
+
+#define REPLAY_MAGIC   0x50525346u // "FSRP"
+#define REPLAY_VERSION 1
+
+// espaço reservado no início de cada quadro gravado: um quadro nunca fica pela
+// metade (marca + tempo + sensor + joystick + a fila de botões inteira)
+#define REPLAY_MAX_FRAME_BYTES (1 + 6 + (1 + 7 * 3) + (1 + 2 * 3) + BUTTON_QUEUE_SIZE * 7)
+
+// bits de replay_header_t.flags
+#define REPLAY_FLAG_JOYSTICK 0x01  // havia joystick na gravação
+
+typedef enum {
+    REPLAY_MODE_OFF,
+    REPLAY_MODE_RECORD,
+    REPLAY_MODE_PLAY
+} replay_mode_t;
+
+// Condições da gravação que a reprodução precisa repetir
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;         // sizeof(replay_header_t)
+    uint32_t build_id;     // identifica a configuração de compilação do jogo
+    uint8_t accel_scale;   // escalas do sensor (a fusão depende delas)
+    uint8_t gyro_scale;
+    uint8_t flags;
+    uint8_t reserved;
+} replay_header_t;
+
+typedef struct {
+    replay_mode_t mode;
+    const uint8_t *data;    // fluxo lido
+    uint8_t *buffer;        // o mesmo fluxo, para escrita (só no modo REPLAY_MODE_RECORD)
+    uint32_t capacity;
+    uint32_t length;
+    uint32_t position;      // posição de leitura no modo REPLAY_MODE_PLAY
+    uint32_t frame_start;   // onde começa o quadro sendo gravado
+    bool ended;             // fim do fluxo, buffer cheio ou dessincronização
+    bool desync;            // a reprodução pediu uma entrada diferente da gravada
+    uint32_t frames;
+    uint32_t last_time_us;
+    mpu6050_raw_data_t last_raw;
+    replay_header_t header;
+} replay_t;
+
+// Começa a gravar em buffer; o cabeçalho é copiado para o início do fluxo
+bool replay_record_start(replay_t *replay, uint8_t *buffer, uint32_t capacity, const replay_header_t *header);
+
+// Começa a reproduzir um fluxo; retorna false se o cabeçalho for inválido
+bool replay_play_start(replay_t *replay, const uint8_t *data, uint32_t length);
+
+// Marca o início de um quadro. Gravando, retorna false (e encerra) quando não
+// cabe mais um quadro; reproduzindo, retorna false no fim do fluxo
+bool replay_frame(replay_t *replay);
+
+// Entradas de um quadro, na ordem em que o laço as consome.
+// put_* gravam; get_* devolvem a entrada gravada (e dessincronizam se o
+// próximo registro for de outro tipo)
+void replay_put_button(replay_t *replay, const button_event *event);
+bool replay_get_button(replay_t *replay, button_event *event);
+
+void replay_put_time(replay_t *replay, uint32_t now_us);
+uint32_t replay_get_time(replay_t *replay);
+
+void replay_put_sensor(replay_t *replay, bool ok, const mpu6050_raw_data_t *raw);
+bool replay_get_sensor(replay_t *replay, mpu6050_raw_data_t *raw);
+
+void replay_put_stick(replay_t *replay, int16_t x, int16_t y);
+void replay_get_stick(replay_t *replay, int16_t *x, int16_t *y);
+
+// Encerra a gravação (o fluxo continua válido até o último quadro completo)
+void replay_stop(replay_t *replay);
+
+#endif
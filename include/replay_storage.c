@@ -0,0 +1,107 @@
+#include "replay_storage.h"
+#include "crc32.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include <stdio.h>
+#include <string.h>
+
+// logo abaixo do setor de configurações, que é o último da flash
+#define REPLAY_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE - REPLAY_FLASH_SIZE)
+#define REPLAY_STREAM_OFFSET (REPLAY_FLASH_OFFSET + FLASH_PAGE_SIZE)
+
+// apagar 64 KB leva centenas de milissegundos, mas só a espera do outro núcleo conta aqui
+#define REPLAY_FLASH_TIMEOUT_MS 100
+
+_Static_assert(REPLAY_FLASH_MAX_STREAM == REPLAY_FLASH_SIZE - FLASH_PAGE_SIZE, "o fluxo começa na segunda página");
+_Static_assert(REPLAY_FLASH_SIZE % FLASH_SECTOR_SIZE == 0, "a área precisa ser de setores inteiros");
+
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+    uint32_t length;
+} replay_flash_op_t;
+
+// Executadas com interrupções desligadas e o outro núcleo parado
+static void replay_do_erase(void *param) {
+    replay_flash_op_t *op = (replay_flash_op_t *)param;
+    flash_range_erase(op->offset, op->length);
+}
+
+static void replay_do_program(void *param) {
+    replay_flash_op_t *op = (replay_flash_op_t *)param;
+    flash_range_program(op->offset, op->data, op->length);
+}
+
+static bool replay_flash(void (*func)(void *), uint32_t offset, const uint8_t *data, uint32_t length) {
+    replay_flash_op_t op = { .offset = offset, .data = data, .length = length };
+    return flash_safe_execute(func, &op, REPLAY_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+static const replay_container_t *replay_flash_container(void) {
+    return (const replay_container_t *)(XIP_BASE + REPLAY_FLASH_OFFSET);
+}
+
+bool replay_storage_save(const replay_t *replay) {
+    uint32_t length = replay->length;
+    if (length > REPLAY_FLASH_MAX_STREAM) return false;
+
+    // descritor + fluxo, arredondado para setores inteiros
+    uint32_t used = FLASH_PAGE_SIZE + length;
+    uint32_t erase = (used + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+    if (!replay_flash(replay_do_erase, REPLAY_FLASH_OFFSET, NULL, erase)) return false;
+
+    // páginas inteiras do fluxo saem direto do buffer; a última é completada com 0xFF
+    uint32_t whole = length / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE;
+    if (whole > 0 && !replay_flash(replay_do_program, REPLAY_STREAM_OFFSET, replay->data, whole)) return false;
+
+    uint8_t page[FLASH_PAGE_SIZE];
+    if (length > whole) {
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page, replay->data + whole, length - whole);
+        if (!replay_flash(replay_do_program, REPLAY_STREAM_OFFSET + whole, page, FLASH_PAGE_SIZE)) return false;
+    }
+
+    // o descritor vai por último: uma gravação interrompida não fica válida
+    replay_container_t container = {
+        .magic = REPLAY_STORAGE_MAGIC,
+        .length = length,
+        .crc = crc32(replay->data, length),
+    };
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &container, sizeof(container));
+    if (!replay_flash(replay_do_program, REPLAY_FLASH_OFFSET, page, FLASH_PAGE_SIZE)) return false;
+
+    const uint8_t *stored;
+    uint32_t stored_length;
+    return replay_storage_load(&stored, &stored_length) && stored_length == length;
+}
+
+bool replay_storage_load(const uint8_t **data, uint32_t *length) {
+    const replay_container_t *container = replay_flash_container();
+    if (container->magic != REPLAY_STORAGE_MAGIC) return false;
+    if (container->length > REPLAY_FLASH_MAX_STREAM) return false;
+
+    const uint8_t *stream = (const uint8_t *)(XIP_BASE + REPLAY_STREAM_OFFSET);
+    if (crc32(stream, container->length) != container->crc) return false;
+
+    *data = stream;
+    *length = container->length;
+    return true;
+}
+
+void replay_storage_dump(const replay_t *replay) {
+    replay_container_t container = {
+        .magic = REPLAY_STORAGE_MAGIC,
+        .length = replay->length,
+        .crc = crc32(replay->data, replay->length),
+    };
+
+    printf("REPLAY %lu\n", (unsigned long)(sizeof(container) + replay->length));
+    stdio_flush();
+
+    const uint8_t *bytes = (const uint8_t *)&container;
+    for (uint32_t i = 0; i < sizeof(container); i++) putchar_raw(bytes[i]);
+    for (uint32_t i = 0; i < replay->length; i++) putchar_raw(replay->data[i]);
+    stdio_flush();
+}
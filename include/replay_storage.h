@@ -0,0 +1,41 @@
+#ifndef REPLAY_STORAGE_H
+#define REPLAY_STORAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "replay.h"
+
+/*
+* Onde as gravações de replay.h ficam guardadas
+* - flash: uma área de REPLAY_FLASH_SIZE logo abaixo do setor de configurações.
+*   A primeira página tem um descritor (magic, tamanho e CRC do fluxo) e o
+*   fluxo vem a partir da segunda; a reprodução lê direto da flash mapeada,
+*   sem copiar para a RAM
+* - USB: o mesmo descritor seguido do fluxo, em binário pelo stdio, depois de
+*   uma linha "REPLAY <bytes>" para o programa do PC achar o início
+*/
+
+#define REPLAY_FLASH_SIZE (64 * 1024)
+
+#define REPLAY_STORAGE_MAGIC 0x43525346u // "FSRC"
+
+// Descritor gravado antes do fluxo (na flash e no USB)
+typedef struct {
+    uint32_t magic;
+    uint32_t length;   // bytes do fluxo
+    uint32_t crc;      // CRC-32 do fluxo
+} replay_container_t;
+
+// Maior fluxo que cabe na área da flash
+#define REPLAY_FLASH_MAX_STREAM (REPLAY_FLASH_SIZE - 256)
+
+// Grava o fluxo na flash (apaga só os setores necessários)
+bool replay_storage_save(const replay_t *replay);
+
+// Procura uma gravação válida na flash; data aponta para a flash mapeada
+bool replay_storage_load(const uint8_t **data, uint32_t *length);
+
+// Envia a gravação pelo stdio (USB ou UART), sem tradução de fim de linha
+void replay_storage_dump(const replay_t *replay);
+
+#endif
@@ -0,0 +1,64 @@
+#include "scheduler.h"
+
+void scheduler_init(scheduler_t *scheduler, uint32_t rate_hz, uint32_t max_steps) {
+    if (rate_hz == 0) rate_hz = SCHEDULER_PHYSICS_RATE_HZ;
+    if (max_steps == 0) max_steps = SCHEDULER_MAX_STEPS;
+
+    scheduler->step_us = 1000000 / rate_hz;
+    scheduler->max_steps = max_steps;
+    scheduler->last_time_us = 0;
+    scheduler->accumulator_us = 0;
+    scheduler->started = false;
+    scheduler_reset_stats(scheduler);
+}
+
+void scheduler_restart(scheduler_t *scheduler) {
+    scheduler->accumulator_us = 0;
+    scheduler->started = false;
+}
+
+void scheduler_reset_stats(scheduler_t *scheduler) {
+    scheduler->frames = 0;
+    scheduler->steps = 0;
+    scheduler->missed_deadlines = 0;
+    scheduler->dropped_us = 0;
+    scheduler->last_frame_us = 0;
+    scheduler->max_frame_us = 0;
+}
+
+uint32_t scheduler_begin_frame(scheduler_t *scheduler, uint32_t now_us) {
+    // o primeiro quadro só marca o tempo inicial
+    if (!scheduler->started) {
+        scheduler->started = true;
+        scheduler->last_time_us = now_us;
+        return 0;
+    }
+
+    // subtração sem sinal funciona mesmo quando o contador de 32 bits dá a volta
+    uint32_t elapsed = now_us - scheduler->last_time_us;
+    scheduler->last_time_us = now_us;
+
+    scheduler->frames++;
+    scheduler->last_frame_us = elapsed;
+    if (elapsed > scheduler->max_frame_us) scheduler->max_frame_us = elapsed;
+
+    scheduler->accumulator_us += elapsed;
+
+    uint32_t steps = scheduler->accumulator_us / scheduler->step_us;
+    if (steps > scheduler->max_steps) {
+        // a simulação não acompanhou o tempo real: descarta o excesso
+        uint32_t kept = scheduler->max_steps * scheduler->step_us;
+        scheduler->dropped_us += scheduler->accumulator_us - kept;
+        scheduler->accumulator_us = kept;
+        scheduler->missed_deadlines++;
+        steps = scheduler->max_steps;
+    }
+
+    scheduler->accumulator_us -= steps * scheduler->step_us;
+    scheduler->steps += steps;
+    return steps;
+}
+
+fix_t scheduler_alpha(const scheduler_t *scheduler) {
+    return (fix_t)(((int64_t)scheduler->accumulator_us << PHYSICS_FRAC_BITS) / scheduler->step_us);
+}
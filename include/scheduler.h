@@ -0,0 +1,57 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "physics.h"
+
+/*
+* Passo de tempo fixo com acumulador
+* Cada quadro soma o tempo real decorrido no acumulador e executa quantos
+* passos de duração fixa couberem nele; o que sobra vira o fator de
+* interpolação usado para desenhar entre o passo anterior e o atual.
+* Assim a velocidade da simulação não depende de quanto o display demora.
+*/
+
+#define SCHEDULER_PHYSICS_RATE_HZ 500
+
+// limite de passos por quadro; acima disso o tempo excedente é descartado
+// (evita a "espiral da morte" quando um quadro demora demais)
+#define SCHEDULER_MAX_STEPS 32
+
+typedef struct {
+    uint32_t step_us;
+    uint32_t max_steps;
+    uint32_t last_time_us;
+    uint32_t accumulator_us;
+    bool started;
+
+    // estatísticas
+    uint32_t frames;
+    uint32_t steps;
+    uint32_t missed_deadlines;  // quadros em que foi preciso descartar tempo
+    uint32_t dropped_us;        // tempo total descartado
+    uint32_t last_frame_us;     // duração do último quadro
+    uint32_t max_frame_us;
+} scheduler_t;
+
+void scheduler_init(scheduler_t *scheduler, uint32_t rate_hz, uint32_t max_steps);
+
+// Começa um quadro no instante now_us e retorna quantos passos fixos executar
+uint32_t scheduler_begin_frame(scheduler_t *scheduler, uint32_t now_us);
+
+// Fração (0..1 em ponto fixo) de passo acumulada depois dos passos do quadro
+fix_t scheduler_alpha(const scheduler_t *scheduler);
+
+// Interpola entre o estado anterior e o atual
+static inline fix_t scheduler_lerp(fix_t previous, fix_t current, fix_t alpha) {
+    return previous + fix_mul(current - previous, alpha);
+}
+
+// Recomeça a contagem de tempo (ex.: depois de uma pausa), sem passos pendentes
+void scheduler_restart(scheduler_t *scheduler);
+
+// Zera as estatísticas (o tempo acumulado é mantido)
+void scheduler_reset_stats(scheduler_t *scheduler);
+
+#endif
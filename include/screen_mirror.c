@@ -0,0 +1,89 @@
+#include "screen_mirror.h"
+#include "display.h"
+#include "framebuffer_diff.h"
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include "tusb.h"
+#include <string.h>
+
+// custo fixo de um trecho no USB: enquadramento da telemetria e cabeçalho da tela
+#define SCREEN_MIRROR_SPAN_OVERHEAD (TELEMETRY_HEADER_SIZE + TELEMETRY_TRAILER_SIZE + TELEMETRY_SCREEN_HEADER_SIZE)
+
+// o que o PC já tem na tela dele
+static uint8_t shadow[FRAMEBUFFER_SIZE] __attribute__((aligned(4)));
+static bool shadow_valid;
+static bool pending;                 // a tela anterior ainda não saiu toda
+static bool connected;
+static uint32_t last_frame_us;
+static uint16_t frame_number;
+static screen_mirror_stats_t stats;
+
+_Static_assert(DISPLAY_WIDTH <= sizeof(((telemetry_screen_t *)0)->data), "a página não cabe no registro");
+
+void screen_mirror_invalidate(void) {
+    shadow_valid = false;
+}
+
+// envia um trecho; false se o USB não tinha espaço
+static bool screen_mirror_span(const uint8_t *buffer, const framebuffer_span_t *span) {
+    int count = framebuffer_span_length(span);
+    telemetry_screen_t record = {
+        .frame = frame_number,
+        .page = span->page,
+        .column = span->start,
+    };
+    memcpy(record.data, &buffer[span->page * DISPLAY_WIDTH + span->start], count);
+
+    if (!telemetry_send_now(TELEMETRY_SCREEN, &record, (uint8_t)(TELEMETRY_SCREEN_HEADER_SIZE + count))) {
+        stats.deferred++;
+        return false;
+    }
+
+    framebuffer_commit(shadow, buffer, span);
+    stats.spans++;
+    stats.bytes += count;
+    return true;
+}
+
+void screen_mirror_frame(const uint8_t *buffer) {
+    // terminal fechado: quando abrir de novo, o PC não tem nada
+    if (!tud_cdc_connected()) {
+        connected = false;
+        return;
+    }
+    if (!connected) {
+        connected = true;
+        screen_mirror_invalidate();
+    }
+
+    uint32_t now = time_us_32();
+    if (!pending && now - last_frame_us < SCREEN_MIRROR_INTERVAL_US) return;
+    if (!pending) {
+        last_frame_us = now;
+        frame_number++;
+    }
+
+    // sem cópia válida, ela vira o inverso da tela: tudo difere e vai inteiro, e o
+    // que não couber agora continua diferente até sair
+    if (!shadow_valid) {
+        for (int i = 0; i < FRAMEBUFFER_SIZE; i++) shadow[i] = (uint8_t)~buffer[i];
+        shadow_valid = true;
+    }
+
+    framebuffer_span_t spans[FRAMEBUFFER_MAX_SPANS];
+    int count = framebuffer_diff(buffer, shadow, SCREEN_MIRROR_SPAN_OVERHEAD, spans);
+
+    // para no primeiro trecho que não coube; os seguintes esperam a vez dele
+    pending = false;
+    for (int i = 0; i < count; i++) {
+        if (!screen_mirror_span(buffer, &spans[i])) {
+            pending = true;
+            return;
+        }
+    }
+    stats.frames++;
+}
+
+screen_mirror_stats_t screen_mirror_stats(void) {
+    return stats;
+}
@@ -0,0 +1,38 @@
+#ifndef SCREEN_MIRROR_H
+#define SCREEN_MIRROR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Espelho da tela pelo USB (-DSCREEN_MIRROR)
+* Depois de cada display_update o conteúdo do buffer vai para o PC como registros
+* TELEMETRY_SCREEN (telemetry.h), para ver no computador o que o painel mostra
+* (tools/screen_viewer.c).
+*
+* Só o que mudou é enviado: os trechos de cada página que diferem da cópia do
+* que o PC já recebeu (framebuffer_diff.h). Um trecho só entra na cópia quando
+* foi escrito no USB, então o que não coube agora sai num dos próximos quadros.
+* Nada espera pelo USB, e uma tela nova só começa a ser comparada a cada
+* SCREEN_MIRROR_INTERVAL_US.
+*/
+
+// intervalo mínimo entre duas telas (10 por segundo)
+#define SCREEN_MIRROR_INTERVAL_US 100000
+
+typedef struct {
+    uint32_t frames;      // telas enviadas por completo
+    uint32_t spans;       // trechos de página enviados
+    uint32_t bytes;       // bytes de imagem enviados
+    uint32_t deferred;    // vezes que o USB estava cheio e um trecho ficou para depois
+} screen_mirror_stats_t;
+
+// Chamado por display_update com o buffer recém-enviado ao painel
+void screen_mirror_frame(const uint8_t *buffer);
+
+// Faz a próxima tela ir inteira (ex.: quando o visualizador é aberto de novo)
+void screen_mirror_invalidate(void);
+
+screen_mirror_stats_t screen_mirror_stats(void);
+
+#endif
@@ -0,0 +1,149 @@
+#include "sdf.h"
+#include "collision.h"
+
+// Menor distância ao quadrado (em pixels²) do ponto (px, py) até uma célula com o valor
+// indicado, procurando em anéis de células cada vez mais distantes até max_px
+static int32_t sdf_nearest_sq(const occupancy_map_t *walls, int px, int py, bool value, int max_px) {
+    int shift = walls->cell_shift;
+    int size = 1 << shift;
+    int cx = px >> shift;
+    int cy = py >> shift;
+    int max_ring = (max_px >> shift) + 1;
+    int32_t best = (max_px + 1) * (max_px + 1);
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+        // as células do anel r ficam a pelo menos (r - 1) células de distância
+        int32_t ring_min = (ring - 1) * size;
+        if (ring_min > 0 && ring_min * ring_min >= best) break;
+
+        for (int y = cy - ring; y <= cy + ring; y++) {
+            // nas linhas do meio só as duas pontas pertencem ao anel
+            int step = (y == cy - ring || y == cy + ring || ring == 0) ? 1 : 2 * ring;
+            for (int x = cx - ring; x <= cx + ring; x += step) {
+                if (occupancy_test(walls, x, y) != value) continue;
+
+                // fora do mapa x e y ficam negativos: multiplicação, não shift
+                int bx0 = x * size, by0 = y * size;
+                int dx = px < bx0 ? bx0 - px : (px > bx0 + size ? px - bx0 - size : 0);
+                int dy = py < by0 ? by0 - py : (py > by0 + size ? py - by0 - size : 0);
+                int32_t dist_sq = dx * dx + dy * dy;
+                if (dist_sq < best) best = dist_sq;
+            }
+        }
+    }
+    return best;
+}
+
+bool sdf_bake(sdf_t *sdf, int8_t *texels, size_t texel_count, const occupancy_map_t *walls, int texel_shift) {
+    int width_px = walls->width << walls->cell_shift;
+    int height_px = walls->height << walls->cell_shift;
+    if ((size_t)SDF_TEXELS(width_px, height_px, texel_shift) > texel_count) return false;
+
+    sdf->texels = texels;
+    sdf->width = (width_px >> texel_shift) + 1;
+    sdf->height = (height_px >> texel_shift) + 1;
+    sdf->texel_shift = (uint8_t)texel_shift;
+
+    for (int ty = 0; ty < sdf->height; ty++) {
+        for (int tx = 0; tx < sdf->width; tx++) {
+            int px = tx << texel_shift;
+            int py = ty << texel_shift;
+
+            // fora das paredes: distância até a parede; encostado ou dentro: até o espaço livre
+            int32_t dist_sq = sdf_nearest_sq(walls, px, py, true, SDF_MAX_DISTANCE);
+            int32_t sign = 1;
+            if (dist_sq == 0) {
+                dist_sq = sdf_nearest_sq(walls, px, py, false, SDF_MAX_DISTANCE);
+                sign = -1;
+            }
+
+            int32_t units = (int32_t)collision_isqrt64((uint64_t)dist_sq << (2 * SDF_UNIT_SHIFT));
+            if (units > 127) units = 127;
+            texels[ty * sdf->width + tx] = (int8_t)(sign * units);
+        }
+    }
+    return true;
+}
+
+// Acha o patch de 2x2 amostras sob o ponto e a posição (0..1) dentro dele
+static const int8_t *sdf_patch(const sdf_t *sdf, fix_t x, fix_t y, fix_t *fx, fix_t *fy) {
+    fix_t max_u = FIX_FROM_INT(sdf->width - 1);
+    fix_t max_v = FIX_FROM_INT(sdf->height - 1);
+    fix_t u = x >> sdf->texel_shift;
+    fix_t v = y >> sdf->texel_shift;
+    if (u < 0) u = 0;
+    if (u > max_u) u = max_u;
+    if (v < 0) v = 0;
+    if (v > max_v) v = max_v;
+
+    int tx = u >> PHYSICS_FRAC_BITS;
+    int ty = v >> PHYSICS_FRAC_BITS;
+    if (tx > sdf->width - 2) tx = sdf->width - 2;
+    if (ty > sdf->height - 2) ty = sdf->height - 2;
+
+    *fx = u - FIX_FROM_INT(tx);
+    *fy = v - FIX_FROM_INT(ty);
+    return &sdf->texels[ty * sdf->width + tx];
+}
+
+// amostra em 1/4 de pixel -> pixels em ponto fixo
+static inline fix_t sdf_texel(int8_t value) {
+    return (fix_t)value * (1 << (PHYSICS_FRAC_BITS - SDF_UNIT_SHIFT));
+}
+
+fix_t sdf_distance(const sdf_t *sdf, fix_t x, fix_t y) {
+    fix_t fx, fy;
+    const int8_t *patch = sdf_patch(sdf, x, y, &fx, &fy);
+    fix_t d00 = sdf_texel(patch[0]), d10 = sdf_texel(patch[1]);
+    fix_t d01 = sdf_texel(patch[sdf->width]), d11 = sdf_texel(patch[sdf->width + 1]);
+
+    fix_t top = d00 + fix_mul(d10 - d00, fx);
+    fix_t bottom = d01 + fix_mul(d11 - d01, fx);
+    return top + fix_mul(bottom - top, fy);
+}
+
+fix_t sdf_query(const sdf_t *sdf, fix_t x, fix_t y, fix_t *normal_x, fix_t *normal_y) {
+    fix_t fx, fy;
+    const int8_t *patch = sdf_patch(sdf, x, y, &fx, &fy);
+    fix_t d00 = sdf_texel(patch[0]), d10 = sdf_texel(patch[1]);
+    fix_t d01 = sdf_texel(patch[sdf->width]), d11 = sdf_texel(patch[sdf->width + 1]);
+
+    fix_t top = d00 + fix_mul(d10 - d00, fx);
+    fix_t bottom = d01 + fix_mul(d11 - d01, fx);
+
+    // derivadas do interpolador bilinear (a escala não importa, só a direção)
+    fix_t grad_x = (d10 - d00) + fix_mul((d11 - d01) - (d10 - d00), fy);
+    fix_t grad_y = bottom - top;
+    fix_t length = (fix_t)collision_isqrt64((uint64_t)((int64_t)grad_x * grad_x + (int64_t)grad_y * grad_y));
+
+    if (length == 0) {
+        *normal_x = 0;
+        *normal_y = 0;
+    } else {
+        *normal_x = (fix_t)(((int64_t)grad_x * FIX_ONE) / length);
+        *normal_y = (fix_t)(((int64_t)grad_y * FIX_ONE) / length);
+    }
+    return top + fix_mul(bottom - top, fy);
+}
+
+void sdf_move_ball(const sdf_t *sdf, physics_ball_t *ball, fix_t radius, fix_t bounce) {
+    // sub-passos de no máximo um raio: a bola não pula para dentro de uma parede grossa
+    fix_t speed_x = ball->vel_x < 0 ? -ball->vel_x : ball->vel_x;
+    fix_t speed_y = ball->vel_y < 0 ? -ball->vel_y : ball->vel_y;
+    int substeps = 1 + (speed_x > speed_y ? speed_x : speed_y) / radius;
+    if (substeps > COLLISION_MAX_SUBSTEPS) substeps = COLLISION_MAX_SUBSTEPS;
+
+    for (int step = 0; step < substeps; step++) {
+        ball->x += ball->vel_x / substeps;
+        ball->y += ball->vel_y / substeps;
+
+        fix_t normal_x, normal_y;
+        fix_t distance = sdf_query(sdf, ball->x, ball->y, &normal_x, &normal_y);
+        if (distance >= radius) continue;
+
+        // empurra para fora ao longo da normal e reflete a velocidade
+        ball->x += fix_mul(normal_x, radius - distance);
+        ball->y += fix_mul(normal_y, radius - distance);
+        collision_reflect(&ball->vel_x, &ball->vel_y, normal_x, normal_y, bounce);
+    }
+}
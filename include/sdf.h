@@ -0,0 +1,49 @@
+#ifndef SDF_H
+#define SDF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "physics.h"
+#include "occupancy.h"
+
+/*
+* Campo de distância com sinal (SDF) do nível
+* No boot o mapa de ocupação é "cozido" numa grade de amostras de int8 com a
+* distância até a parede mais próxima: positiva no espaço livre, negativa
+* dentro das paredes. A consulta é uma interpolação bilinear de 4 amostras,
+* O(1) e sem depender do formato do nível, e o gradiente do mesmo patch dá a
+* normal da parede para o quique. Serve para a bola e para partículas.
+*/
+
+// distâncias guardadas em 1/4 de pixel: o int8 cobre ±31 pixels
+#define SDF_UNIT_SHIFT 2
+#define SDF_MAX_DISTANCE (127 >> SDF_UNIT_SHIFT)
+
+// amostras nos cantos de uma grade de 2^shift pixels (inclui a última borda)
+#define SDF_TEXELS(width_px, height_px, texel_shift) \
+    ((((width_px) >> (texel_shift)) + 1) * (((height_px) >> (texel_shift)) + 1))
+
+typedef struct {
+    int8_t *texels;       // width * height amostras, linha a linha
+    int width;            // amostras por linha
+    int height;
+    uint8_t texel_shift;  // log2 dos pixels entre amostras
+} sdf_t;
+
+// Calcula o campo do mapa de paredes sobre o armazenamento fornecido
+// Retorna false se o armazenamento for pequeno demais
+bool sdf_bake(sdf_t *sdf, int8_t *texels, size_t texel_count, const occupancy_map_t *walls, int texel_shift);
+
+// Distância em pixels (ponto fixo) do ponto (x, y) até a parede mais próxima
+fix_t sdf_distance(const sdf_t *sdf, fix_t x, fix_t y);
+
+// Distância e normal unitária (apontando para longe da parede); a normal é zero em platôs
+fix_t sdf_query(const sdf_t *sdf, fix_t x, fix_t y, fix_t *normal_x, fix_t *normal_y);
+
+// Move a bola pela velocidade de um passo, empurrando-a para fora das paredes e
+// refletindo a velocidade na normal do campo. Paredes com menos de um raio de
+// espessura podem ser atravessadas em velocidades altas.
+void sdf_move_ball(const sdf_t *sdf, physics_ball_t *ball, fix_t radius, fix_t bounce);
+
+#endif
@@ -0,0 +1,140 @@
+#include "settings.h"
+#include "crc32.h"
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include <stddef.h>
+#include <string.h>
+
+// o setor de configurações é o último da flash, longe do programa
+#define SETTINGS_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+#define SETTINGS_SLOT_SIZE    FLASH_PAGE_SIZE
+#define SETTINGS_SLOT_COUNT   ((int)(FLASH_SECTOR_SIZE / SETTINGS_SLOT_SIZE))
+
+// tempo máximo para o outro núcleo liberar a flash
+#define SETTINGS_FLASH_TIMEOUT_MS 100
+
+// Formato de um slot gravado
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t length;
+    uint32_t sequence;
+    settings_t data;
+    uint32_t crc;      // CRC de todos os campos anteriores
+} settings_record_t;
+
+_Static_assert(sizeof(settings_record_t) <= SETTINGS_SLOT_SIZE, "registro maior que um slot");
+
+// Parâmetros passados para as rotinas executadas com a flash liberada
+typedef struct {
+    uint32_t offset;
+    const uint8_t *data;
+} settings_flash_op_t;
+
+// Endereço mapeado (XIP) de um slot
+static const settings_record_t *settings_slot(int slot) {
+    return (const settings_record_t *)(XIP_BASE + SETTINGS_FLASH_OFFSET + slot * SETTINGS_SLOT_SIZE);
+}
+
+// Um slot apagado tem todos os bits em 1
+static bool settings_slot_is_empty(int slot) {
+    const uint32_t *words = (const uint32_t *)settings_slot(slot);
+    for (uint32_t i = 0; i < sizeof(settings_record_t) / sizeof(uint32_t); i++) {
+        if (words[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+static bool settings_slot_is_valid(int slot) {
+    const settings_record_t *record = settings_slot(slot);
+
+    if (record->magic != SETTINGS_MAGIC) return false;
+    if (record->version != SETTINGS_VERSION) return false;
+    if (record->length != sizeof(settings_t)) return false;
+    return record->crc == crc32(record, offsetof(settings_record_t, crc));
+}
+
+// Retorna o slot válido mais recente, ou -1 se nenhum
+static int settings_find_latest(void) {
+    int latest = -1;
+    uint32_t latest_sequence = 0;
+
+    for (int slot = 0; slot < SETTINGS_SLOT_COUNT; slot++) {
+        if (!settings_slot_is_valid(slot)) continue;
+
+        uint32_t sequence = settings_slot(slot)->sequence;
+        if (latest < 0 || (int32_t)(sequence - latest_sequence) > 0) {
+            latest = slot;
+            latest_sequence = sequence;
+        }
+    }
+    return latest;
+}
+
+// Executadas com interrupções desligadas e o outro núcleo parado
+static void settings_do_erase(void *param) {
+    (void)param;
+    flash_range_erase(SETTINGS_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+}
+
+static void settings_do_program(void *param) {
+    settings_flash_op_t *op = (settings_flash_op_t *)param;
+    flash_range_program(op->offset, op->data, SETTINGS_SLOT_SIZE);
+}
+
+bool settings_load(settings_t *settings) {
+    int slot = settings_find_latest();
+    if (slot < 0) return false;
+
+    memcpy(settings, &settings_slot(slot)->data, sizeof(settings_t));
+    return true;
+}
+
+bool settings_save(const settings_t *settings) {
+    int latest = settings_find_latest();
+    uint32_t sequence = latest < 0 ? 0 : settings_slot(latest)->sequence + 1;
+
+    // procura um slot livre a partir do mais recente, dando a volta no setor
+    int target = -1;
+    int start = latest < 0 ? 0 : latest + 1;
+    for (int i = 0; i < SETTINGS_SLOT_COUNT; i++) {
+        int slot = (start + i) % SETTINGS_SLOT_COUNT;
+        if (settings_slot_is_empty(slot)) {
+            target = slot;
+            break;
+        }
+    }
+
+    // setor cheio: apaga tudo e recomeça do primeiro slot
+    if (target < 0) {
+        if (!settings_erase()) return false;
+        target = 0;
+    }
+
+    // a flash só pode ser programada em páginas inteiras
+    uint8_t page[SETTINGS_SLOT_SIZE];
+    memset(page, 0xFF, sizeof(page));
+
+    settings_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.magic = SETTINGS_MAGIC;
+    record.version = SETTINGS_VERSION;
+    record.length = sizeof(settings_t);
+    record.sequence = sequence;
+    record.data = *settings;
+    record.crc = crc32(&record, offsetof(settings_record_t, crc));
+    memcpy(page, &record, sizeof(record));
+
+    settings_flash_op_t op = {
+        .offset = SETTINGS_FLASH_OFFSET + target * SETTINGS_SLOT_SIZE,
+        .data = page,
+    };
+    if (flash_safe_execute(settings_do_program, &op, SETTINGS_FLASH_TIMEOUT_MS) != PICO_OK) return false;
+
+    return settings_slot_is_valid(target);
+}
+
+bool settings_erase(void) {
+    return flash_safe_execute(settings_do_erase, NULL, SETTINGS_FLASH_TIMEOUT_MS) == PICO_OK;
+}
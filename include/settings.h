@@ -0,0 +1,35 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mpu6050.h"
+
+/*
+* Configurações persistentes gravadas no último setor da flash
+* O setor (4 KB) é dividido em slots do tamanho de uma página (256 bytes).
+* Cada gravação usa o próximo slot livre, e o setor só é apagado quando todos
+* os slots foram usados, espalhando o desgaste. Na leitura vale o registro
+* válido (magic, versão, tamanho e CRC conferem) com o maior número de sequência.
+*/
+
+#define SETTINGS_MAGIC   0x4D495346u // "FSIM"
+#define SETTINGS_VERSION 1
+
+// Dados que sobrevivem ao reset
+typedef struct {
+    mpu6050_offsets_t offsets;
+    uint8_t accel_scale;   // escalas em que os offsets foram medidos
+    uint8_t gyro_scale;
+} settings_t;
+
+// Lê a configuração mais recente; retorna false se não houver registro válido
+bool settings_load(settings_t *settings);
+
+// Grava a configuração em um novo slot; retorna false se a gravação falhar
+bool settings_save(const settings_t *settings);
+
+// Apaga o setor inteiro, invalidando todas as configurações
+bool settings_erase(void);
+
+#endif
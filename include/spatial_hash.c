@@ -0,0 +1,66 @@
+#include "spatial_hash.h"
+#include <string.h>
+
+void spatial_hash_init(spatial_hash_t *hash, uint16_t *cell_start, uint16_t *sorted, uint16_t *body_cell,
+                       int capacity, int width, int height, int cell_shift) {
+    hash->cell_start = cell_start;
+    hash->sorted = sorted;
+    hash->body_cell = body_cell;
+    hash->capacity = capacity;
+    hash->count = 0;
+    hash->width = width;
+    hash->height = height;
+    hash->cell_shift = (uint8_t)cell_shift;
+    memset(cell_start, 0, (size_t)(width * height + 1) * sizeof(uint16_t));
+}
+
+void spatial_hash_sort(spatial_hash_t *hash, int count) {
+    int cells = hash->width * hash->height;
+    uint16_t *start = hash->cell_start;
+
+    if (count > hash->capacity) count = hash->capacity;
+    hash->count = count;
+
+    memset(start, 0, (size_t)(cells + 1) * sizeof(uint16_t));
+
+    // contagem deslocada de uma posição e soma prefixada: start[c] = início da célula c
+    for (int i = 0; i < count; i++) start[hash->body_cell[i] + 1]++;
+    for (int c = 0; c < cells; c++) start[c + 1] += start[c];
+
+    // preencher avança cada início até o início da célula seguinte...
+    for (int i = 0; i < count; i++) hash->sorted[start[hash->body_cell[i]]++] = (uint16_t)i;
+
+    // ...então basta deslocar uma posição para restaurar os inícios
+    for (int c = cells; c > 0; c--) start[c] = start[c - 1];
+    start[0] = 0;
+}
+
+void spatial_hash_build(spatial_hash_t *hash, const fix_t *x, const fix_t *y, int stride, int count) {
+    if (count > hash->capacity) count = hash->capacity;
+
+    for (int i = 0; i < count; i++) {
+        hash->body_cell[i] = spatial_hash_cell_of(hash, x[i * stride], y[i * stride]);
+    }
+    spatial_hash_sort(hash, count);
+}
+
+int spatial_hash_query(const spatial_hash_t *hash, fix_t x, fix_t y, fix_t radius, uint16_t *out, int max) {
+    int shift = PHYSICS_FRAC_BITS + hash->cell_shift;
+    int x0 = (x - radius) >> shift, x1 = (x + radius) >> shift;
+    int y0 = (y - radius) >> shift, y1 = (y + radius) >> shift;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= hash->width) x1 = hash->width - 1;
+    if (y1 >= hash->height) y1 = hash->height - 1;
+    if (x0 > x1 || y0 > y1) return 0;
+
+    int found = 0;
+    for (int cy = y0; cy <= y1; cy++) {
+        int row = cy * hash->width;
+        int end = hash->cell_start[row + x1 + 1];
+        for (int k = hash->cell_start[row + x0]; k < end && found < max; k++) {
+            out[found++] = hash->sorted[k];
+        }
+    }
+    return found;
+}
@@ -0,0 +1,90 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "physics.h"
+
+/*
+* Grade uniforme de vizinhança para muitos corpos em movimento
+* A cada passo os corpos são distribuídos em células quadradas de 2^shift
+* pixels por ordenação por contagem (duas passadas, sem comparação e sem
+* alocação): sorted[] fica com os índices agrupados por célula e
+* cell_start[c]..cell_start[c + 1] delimita a célula c. Como as células de
+* uma linha são contíguas, a vizinhança 3x3 de um corpo são só três
+* intervalos de sorted[].
+*
+* Com o lado da célula >= à distância de interação, basta olhar a vizinhança
+* 3x3. Corpos fora da grade são presos na célula da borda.
+* Os arrays são fornecidos por quem usa (estáticos ou dentro de outra struct).
+*/
+
+typedef struct {
+    uint16_t *cell_start;  // width * height + 1
+    uint16_t *sorted;      // capacity
+    uint16_t *body_cell;   // capacity: célula de cada corpo
+    int capacity;
+    int count;
+    int width;             // em células
+    int height;
+    uint8_t cell_shift;    // log2 do lado da célula em pixels
+} spatial_hash_t;
+
+// Primeira e última célula (inclusive) da vizinhança 3x3 de uma célula, já recortada
+typedef struct {
+    int x0, x1, y0, y1;
+} spatial_hash_range_t;
+
+void spatial_hash_init(spatial_hash_t *hash, uint16_t *cell_start, uint16_t *sorted, uint16_t *body_cell,
+                       int capacity, int width, int height, int cell_shift);
+
+// Célula do ponto (x, y) em pixels, presa à grade
+static inline uint16_t spatial_hash_cell_of(const spatial_hash_t *hash, fix_t x, fix_t y) {
+    int cx = FIX_TO_INT(x) >> hash->cell_shift;
+    int cy = FIX_TO_INT(y) >> hash->cell_shift;
+    if (cx < 0) cx = 0;
+    if (cx >= hash->width) cx = hash->width - 1;
+    if (cy < 0) cy = 0;
+    if (cy >= hash->height) cy = hash->height - 1;
+    return (uint16_t)(cy * hash->width + cx);
+}
+
+// Ordena os count primeiros corpos pela célula já gravada em body_cell[]
+// (permite calcular as células em paralelo, junto com a integração)
+void spatial_hash_sort(spatial_hash_t *hash, int count);
+
+// Calcula as células e ordena; x e y avançam stride elementos por corpo
+// (1 para arrays separados, sizeof(struct) / sizeof(fix_t) para arrays de structs)
+void spatial_hash_build(spatial_hash_t *hash, const fix_t *x, const fix_t *y, int stride, int count);
+
+static inline spatial_hash_range_t spatial_hash_neighbourhood(const spatial_hash_t *hash, uint16_t cell) {
+    spatial_hash_range_t range;
+    int cx = cell % hash->width;
+    int cy = cell / hash->width;
+    range.x0 = cx > 0 ? cx - 1 : 0;
+    range.x1 = cx < hash->width - 1 ? cx + 1 : cx;
+    range.y0 = cy > 0 ? cy - 1 : 0;
+    range.y1 = cy < hash->height - 1 ? cy + 1 : cy;
+    return range;
+}
+
+// Percorre os índices j dos corpos na vizinhança 3x3 da célula (inclui o próprio corpo);
+// o corpo do laço vai por último e pode conter vírgulas
+#define SPATIAL_HASH_FOR_EACH_NEAR(hash, cell, j, ...)                                         \
+    do {                                                                                       \
+        spatial_hash_range_t near_range = spatial_hash_neighbourhood((hash), (cell));          \
+        for (int near_y = near_range.y0; near_y <= near_range.y1; near_y++) {                  \
+            int near_row = near_y * (hash)->width;                                             \
+            int near_end = (hash)->cell_start[near_row + near_range.x1 + 1];                   \
+            for (int near_k = (hash)->cell_start[near_row + near_range.x0]; near_k < near_end; near_k++) { \
+                int j = (hash)->sorted[near_k];                                                \
+                __VA_ARGS__                                                                    \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+// Copia para out os índices dos corpos nas células que o círculo (x, y, radius) toca
+// Retorna quantos foram escritos (no máximo max)
+int spatial_hash_query(const spatial_hash_t *hash, fix_t x, fix_t y, fix_t radius, uint16_t *out, int max);
+
+#endif
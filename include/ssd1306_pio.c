@@ -0,0 +1,162 @@
+#ifdef DISPLAY_PIO_I2C
+#include "ssd1306_pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/pio.h"
+#include "pico/stdlib.h"
+#include "ssd1306_i2c.pio.h"
+#include <string.h>
+
+// folga do tempo limite: sem clock stretching o tempo no barramento é exato,
+// o limite só protege de uma máquina parada
+#define SSD1306_PIO_TIMEOUT_MARGIN_US 1000
+
+static PIO ssd1306_pio;
+static unsigned int ssd1306_sm;
+static unsigned int ssd1306_offset;
+static int ssd1306_dma = -1;
+static unsigned int ssd1306_sda_pin;
+static unsigned int ssd1306_scl_pin;
+static uint16_t ssd1306_clkdiv;
+static uint32_t ssd1306_baudrate;
+
+// envio em andamento (0 = nenhum) e quando começou
+static size_t pending_length = 0;
+static uint32_t pending_start_us;
+
+// o menor divisor que não passa do clock pedido
+static uint16_t ssd1306_pio_clkdiv(uint32_t baudrate) {
+    uint32_t cycles = baudrate * SSD1306_I2C_CYCLES_PER_BIT;
+    uint32_t div = (clock_get_hz(clk_sys) + cycles - 1) / cycles;
+    if (div < 1) div = 1;
+    if (div > 0xFFFF) div = 0xFFFF;
+    return (uint16_t)div;
+}
+
+static void ssd1306_pio_start(void) {
+    pio_interrupt_clear(ssd1306_pio, ssd1306_sm);
+    ssd1306_i2c_program_init(ssd1306_pio, ssd1306_sm, ssd1306_offset, ssd1306_sda_pin, ssd1306_scl_pin,
+                             ssd1306_clkdiv);
+}
+
+static void ssd1306_pio_stop(void) {
+    dma_channel_abort(ssd1306_dma);
+    pio_sm_set_enabled(ssd1306_pio, ssd1306_sm, false);
+    pio_sm_clear_fifos(ssd1306_pio, ssd1306_sm);
+    pending_length = 0;
+}
+
+uint32_t ssd1306_pio_init(unsigned int sda_pin, unsigned int scl_pin, uint32_t baudrate) {
+    if (!pio_claim_free_sm_and_add_program(&ssd1306_i2c_program, &ssd1306_pio, &ssd1306_sm, &ssd1306_offset)) {
+        return 0;
+    }
+
+    int channel = dma_claim_unused_channel(false);
+    if (channel < 0) {
+        pio_remove_program_and_unclaim_sm(&ssd1306_i2c_program, ssd1306_pio, ssd1306_sm, ssd1306_offset);
+        return 0;
+    }
+    ssd1306_dma = channel;
+
+    // um byte por vez no FIFO da máquina, no ritmo em que ela pede
+    dma_channel_config config = dma_channel_get_default_config(channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_dreq(&config, pio_get_dreq(ssd1306_pio, ssd1306_sm, true));
+    dma_channel_configure(channel, &config, &ssd1306_pio->txf[ssd1306_sm], NULL, 0, false);
+
+    ssd1306_sda_pin = sda_pin;
+    ssd1306_scl_pin = scl_pin;
+    ssd1306_clkdiv = ssd1306_pio_clkdiv(baudrate);
+    ssd1306_baudrate = clock_get_hz(clk_sys) / (SSD1306_I2C_CYCLES_PER_BIT * ssd1306_clkdiv);
+    pending_length = 0;
+    ssd1306_pio_start();
+    return ssd1306_baudrate;
+}
+
+void ssd1306_pio_deinit(void) {
+    if (ssd1306_dma < 0) return;
+    ssd1306_pio_stop();
+    dma_channel_unclaim(ssd1306_dma);
+    ssd1306_dma = -1;
+    pio_remove_program_and_unclaim_sm(&ssd1306_i2c_program, ssd1306_pio, ssd1306_sm, ssd1306_offset);
+}
+
+uint32_t ssd1306_pio_set_baudrate(uint32_t baudrate) {
+    if (ssd1306_dma < 0) return 0;
+    ssd1306_clkdiv = ssd1306_pio_clkdiv(baudrate);
+    pio_sm_set_clkdiv_int_frac(ssd1306_pio, ssd1306_sm, ssd1306_clkdiv, 0);
+    pio_sm_clkdiv_restart(ssd1306_pio, ssd1306_sm);
+    ssd1306_baudrate = clock_get_hz(clk_sys) / (SSD1306_I2C_CYCLES_PER_BIT * ssd1306_clkdiv);
+    return ssd1306_baudrate;
+}
+
+size_t ssd1306_pio_transaction(uint8_t *stream, uint8_t address, uint8_t control, const uint8_t *data, size_t length) {
+    // o programa conta os bytes depois do START menos um: endereço, controle e dados
+    stream[0] = (uint8_t)(length + 1);
+    stream[1] = (uint8_t)(address << 1);
+    stream[2] = control;
+    memcpy(&stream[3], data, length);
+    return length + SSD1306_PIO_TRANSACTION_OVERHEAD;
+}
+
+void ssd1306_pio_send(const uint8_t *stream, size_t length) {
+    if (!length || ssd1306_dma < 0) return;
+    pending_length = length;
+    pending_start_us = time_us_32();
+    dma_channel_transfer_from_buffer_now(ssd1306_dma, stream, length);
+}
+
+// o dobro do tempo no barramento (9 pulsos por byte, mais START e STOP) mais a folga
+static bool ssd1306_pio_expired(void) {
+    uint32_t bits = (uint32_t)pending_length * 9 + 4;
+    uint32_t timeout = 2 * (uint32_t)((uint64_t)bits * 1000000 / ssd1306_baudrate) + SSD1306_PIO_TIMEOUT_MARGIN_US;
+    return time_us_32() - pending_start_us >= timeout;
+}
+
+bool ssd1306_pio_wait(i2c_bus_stats_t *stats) {
+    if (!pending_length) return true;
+
+    // o DMA acaba quando o último byte entra no FIFO; a máquina acaba quando, com o
+    // FIFO vazio, para no pull do começo de uma transação (o aviso de parada é
+    // apagado e volta a acender enquanto ela está parada)
+    bool timed_out = false;
+    while (dma_channel_is_busy(ssd1306_dma) || !pio_sm_is_tx_fifo_empty(ssd1306_pio, ssd1306_sm)) {
+        if ((timed_out = ssd1306_pio_expired())) break;
+    }
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + ssd1306_sm);
+    ssd1306_pio->fdebug = stall;
+    while (!timed_out && !(ssd1306_pio->fdebug & stall)) {
+        timed_out = ssd1306_pio_expired();
+    }
+
+    // a máquina levanta a IRQ dela quando falta um ACK (e pula o resto daquela transação)
+    bool nack = pio_interrupt_get(ssd1306_pio, ssd1306_sm);
+    pio_interrupt_clear(ssd1306_pio, ssd1306_sm);
+    pending_length = 0;
+
+    if (timed_out) {
+        ssd1306_pio_stop();
+        ssd1306_pio_start();
+    }
+    if (nack || timed_out) {
+        stats->errors++;
+        stats->consecutive++;
+        if (timed_out) stats->timeouts++;
+        return false;
+    }
+    stats->consecutive = 0;
+    return true;
+}
+
+void ssd1306_pio_reset(void) {
+    if (ssd1306_dma < 0) return;
+    ssd1306_pio_stop();
+    // i2c_bus_clear devolve os pinos ao periférico I2C; o start os devolve ao PIO
+    i2c_bus_clear(ssd1306_sda_pin, ssd1306_scl_pin);
+    ssd1306_pio_start();
+}
+
+#endif
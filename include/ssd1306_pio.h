@@ -0,0 +1,46 @@
+#ifndef SSD1306_PIO_H
+#define SSD1306_PIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "i2c_bus.h"
+
+/*
+* Mestre I2C do display no PIO, alimentado por DMA (compilado com -DDISPLAY_PIO_I2C)
+* O periférico I2C do RP2040 para em 1 MHz, e as escritas do SDK põem byte a
+* byte no FIFO com o processador esperando. Aqui o programa ssd1306_i2c.pio
+* gera START, bits, ACK e STOP sozinho, e um canal de DMA entrega um fluxo de
+* transações já montado: o processador monta o fluxo, dispara e vai cuidar do
+* próximo quadro enquanto ele sai. Só escrita e sem clock stretching, que é
+* tudo o que o SSD1306 usa.
+*/
+
+// dados de uma transação: o contador do fluxo tem 8 bits e conta também o endereço e o controle
+#define SSD1306_PIO_MAX_TRANSACTION 254
+
+// bytes de uma transação no fluxo além dos dados: contador, endereço e controle
+#define SSD1306_PIO_TRANSACTION_OVERHEAD 3
+
+// Pega uma máquina de estados livre e um canal de DMA; como o i2c_init, retorna o
+// clock de fato obtido (0 se não houver máquina ou canal livre)
+uint32_t ssd1306_pio_init(unsigned int sda_pin, unsigned int scl_pin, uint32_t baudrate);
+void ssd1306_pio_deinit(void);
+
+// Troca o clock (sem envio em andamento); retorna o clock de fato obtido pelo divisor inteiro
+uint32_t ssd1306_pio_set_baudrate(uint32_t baudrate);
+
+// Escreve no fluxo uma transação (endereço de 7 bits, byte de controle e até
+// SSD1306_PIO_MAX_TRANSACTION bytes de dados); retorna quantos bytes ela ocupou
+size_t ssd1306_pio_transaction(uint8_t *stream, uint8_t address, uint8_t control, const uint8_t *data, size_t length);
+
+// Começa a mandar o fluxo por DMA e retorna na hora; ele não pode mudar até ssd1306_pio_wait
+void ssd1306_pio_send(const uint8_t *stream, size_t length);
+
+// Espera o fim do último envio; retorna se todos os bytes tiveram ACK e conta as falhas
+bool ssd1306_pio_wait(i2c_bus_stats_t *stats);
+
+// Para a máquina, limpa o barramento (como i2c_bus_clear) e recomeça do zero
+void ssd1306_pio_reset(void);
+
+#endif
@@ -0,0 +1,152 @@
+#include "telemetry.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "tusb.h"
+#include <string.h>
+
+_Static_assert((TELEMETRY_BUFFER_SIZE & (TELEMETRY_BUFFER_SIZE - 1)) == 0, "o buffer precisa ser potência de 2");
+_Static_assert(TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_PAYLOAD + TELEMETRY_TRAILER_SIZE <= TELEMETRY_FRAME_BUDGET,
+               "um registro precisa caber no orçamento do quadro");
+
+// posições livres (só crescem); a ocupação é head - tail, e record_tail é o início
+// do registro mais antigo que ainda não saiu inteiro (tail pode estar no meio dele)
+static uint8_t buffer[TELEMETRY_BUFFER_SIZE];
+static uint32_t head;
+static uint32_t tail;
+static uint32_t record_tail;
+
+static uint16_t sequence;
+static uint32_t frame_bytes;
+static telemetry_stats_t stats;
+
+void telemetry_init(void) {
+    head = 0;
+    tail = 0;
+    record_tail = 0;
+    sequence = 0;
+    frame_bytes = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+static void telemetry_put(const uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        buffer[head++ & (TELEMETRY_BUFFER_SIZE - 1)] = data[i];
+    }
+}
+
+// tamanho total do registro que começa em start, pelo campo de tamanho do cabeçalho
+static uint32_t telemetry_record_size(uint32_t start) {
+    return TELEMETRY_HEADER_SIZE + buffer[(start + 3) & (TELEMETRY_BUFFER_SIZE - 1)] + TELEMETRY_TRAILER_SIZE;
+}
+
+// cabeçalho e CRC de um registro com a próxima sequência
+static void telemetry_frame(uint8_t *header, uint8_t *trailer, telemetry_type_t type,
+                            const void *payload, uint8_t length) {
+    header[0] = TELEMETRY_SYNC0;
+    header[1] = TELEMETRY_SYNC1;
+    header[2] = (uint8_t)type;
+    header[3] = length;
+    header[4] = (uint8_t)sequence;
+    header[5] = (uint8_t)(sequence >> 8);
+
+    uint16_t crc = telemetry_crc16(0xFFFF, header + 2, TELEMETRY_HEADER_SIZE - 2);
+    crc = telemetry_crc16(crc, payload, length);
+    trailer[0] = (uint8_t)crc;
+    trailer[1] = (uint8_t)(crc >> 8);
+}
+
+bool telemetry_send(telemetry_type_t type, const void *payload, uint8_t length) {
+    uint32_t total = TELEMETRY_HEADER_SIZE + length + TELEMETRY_TRAILER_SIZE;
+    if (length > TELEMETRY_MAX_PAYLOAD ||
+        frame_bytes + total > TELEMETRY_FRAME_BUDGET ||
+        TELEMETRY_BUFFER_SIZE - (head - record_tail) < total) {
+        stats.dropped_records++;
+        return false;
+    }
+
+    uint8_t header[TELEMETRY_HEADER_SIZE];
+    uint8_t trailer[TELEMETRY_TRAILER_SIZE];
+    telemetry_frame(header, trailer, type, payload, length);
+
+    telemetry_put(header, sizeof(header));
+    telemetry_put(payload, length);
+    telemetry_put(trailer, sizeof(trailer));
+
+    sequence++;
+    frame_bytes += total;
+    return true;
+}
+
+// copia para a fila do TinyUSB o que couber do buffer; com as interrupções desligadas
+static void telemetry_drain(void) {
+    uint32_t pending = head - tail;
+    uint32_t space = tud_cdc_write_available();
+    uint32_t count = pending < space ? pending : space;
+
+    while (count > 0) {
+        uint32_t offset = tail & (TELEMETRY_BUFFER_SIZE - 1);
+        uint32_t chunk = TELEMETRY_BUFFER_SIZE - offset;
+        if (chunk > count) chunk = count;
+
+        uint32_t written = tud_cdc_write(buffer + offset, chunk);
+        tail += written;
+        stats.sent_bytes += written;
+        count -= written;
+        if (written < chunk) break;
+    }
+
+    while (record_tail != head && tail - record_tail >= telemetry_record_size(record_tail)) {
+        record_tail += telemetry_record_size(record_tail);
+    }
+}
+
+void telemetry_flush(void) {
+    frame_bytes = 0;
+
+    // sem terminal aberto no PC não há para quem mandar: o que estava no buffer é
+    // descartado e contado (um registro que já saiu pela metade também se perde)
+    if (!tud_cdc_connected()) {
+        while (record_tail != head) {
+            record_tail += telemetry_record_size(record_tail);
+            stats.dropped_records++;
+        }
+        tail = head;
+        return;
+    }
+
+    // o stdio do USB também escreve no CDC (e atende o USB numa interrupção):
+    // a cópia para a fila do TinyUSB é curta e feita com as interrupções desligadas
+    uint32_t status = save_and_disable_interrupts();
+    telemetry_drain();
+    tud_cdc_write_flush();
+    restore_interrupts(status);
+}
+
+bool telemetry_send_now(telemetry_type_t type, const void *payload, uint8_t length) {
+    uint32_t total = TELEMETRY_HEADER_SIZE + length + TELEMETRY_TRAILER_SIZE;
+    if (length > TELEMETRY_MAX_DIRECT_PAYLOAD || !tud_cdc_connected()) return false;
+
+    uint8_t header[TELEMETRY_HEADER_SIZE];
+    uint8_t trailer[TELEMETRY_TRAILER_SIZE];
+    telemetry_frame(header, trailer, type, payload, length);
+
+    // o buffer sai antes (a ordem dos registros se mantém); depois o registro cabe
+    // inteiro ou fica para depois, sem o stdio no meio (veja telemetry_flush)
+    uint32_t status = save_and_disable_interrupts();
+    telemetry_drain();
+    bool fits = head == tail && tud_cdc_write_available() >= total;
+    if (fits) {
+        tud_cdc_write(header, sizeof(header));
+        tud_cdc_write(payload, length);
+        tud_cdc_write(trailer, sizeof(trailer));
+        sequence++;
+        stats.sent_bytes += total;
+    }
+    tud_cdc_write_flush();
+    restore_interrupts(status);
+    return fits;
+}
+
+telemetry_stats_t telemetry_stats(void) {
+    return stats;
+}
@@ -0,0 +1,136 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+* Telemetria binária pelo USB (CDC)
+* Cada registro é uma struct de tamanho fixo copiada como está (sem printf),
+* dentro de um quadro:
+*
+*   0xA5 0x5A | tipo | tamanho | sequência (16 bits) | dados | CRC-16 (16 bits)
+*
+* O CRC (CCITT, sobre tipo..dados) e a sequência deixam o decodificador achar o
+* início de cada registro mesmo com texto do printf misturado no mesmo canal,
+* e contar os registros perdidos. Tudo em little-endian, como no RP2040.
+*
+* Os registros são montados num buffer circular e enviados de uma vez no fim
+* do quadro, só com o espaço que o USB tiver livre: nada bloqueia. Cada quadro
+* tem um orçamento de bytes; o que passar dele (ou não couber no buffer) é
+* descartado e contado.
+*
+* Registros grandes (as páginas do espelho da tela, screen_mirror.h) não passam
+* pelo buffer: vão direto para o USB com telemetry_send_now, inteiros ou nada.
+*
+* O decodificador do PC é tools/telemetry_decode.c.
+*/
+
+#define TELEMETRY_SYNC0 0xA5
+#define TELEMETRY_SYNC1 0x5A
+
+#define TELEMETRY_HEADER_SIZE  6
+#define TELEMETRY_TRAILER_SIZE 2
+#define TELEMETRY_MAX_PAYLOAD  64
+#define TELEMETRY_MAX_DIRECT_PAYLOAD (TELEMETRY_SCREEN_HEADER_SIZE + 128)
+
+// buffer circular (potência de 2) e bytes aceitos por quadro
+#define TELEMETRY_BUFFER_SIZE  2048
+#define TELEMETRY_FRAME_BUDGET 256
+
+typedef enum {
+    TELEMETRY_SENSOR = 1,
+    TELEMETRY_BALL,
+    TELEMETRY_FRAME,
+    TELEMETRY_ERRORS,
+    TELEMETRY_SCREEN
+} telemetry_type_t;
+
+// leitura crua do MPU6050
+typedef struct {
+    uint32_t time_us;
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t temperature;
+    uint16_t reserved;
+} telemetry_sensor_t;
+
+// estado de uma bola (ponto fixo da física)
+typedef struct {
+    uint32_t time_us;
+    int32_t x, y;
+    int32_t vel_x, vel_y;
+    uint16_t index;
+    uint16_t reserved;
+} telemetry_ball_t;
+
+// tempos de um quadro
+typedef struct {
+    uint32_t time_us;
+    uint32_t frame_us;          // duração do quadro anterior
+    uint16_t physics_steps;
+    uint16_t sensor_steps;
+    uint32_t missed_deadlines;  // total do escalonador
+    uint32_t dropped_records;   // registros de telemetria descartados até agora
+} telemetry_frame_t;
+
+// contadores de erro
+typedef struct {
+    uint32_t time_us;
+    uint32_t sensor_errors;     // leituras do MPU6050 que falharam
+    uint32_t display_errors;    // escritas no display que falharam
+    uint32_t button_dropped;    // eventos perdidos com a fila de botões cheia
+    uint16_t sensor_timeouts;   // transferências do barramento do sensor que não terminaram
+    uint16_t sensor_recoveries; // barramento do sensor limpo e sensor reconfigurado
+    uint16_t display_timeouts;
+    uint16_t display_recoveries;
+} telemetry_errors_t;
+
+// trecho de uma página da tela: as colunas column..column + n - 1, com n tirado do
+// tamanho do registro (só os bytes que mudaram desde o último envio)
+#define TELEMETRY_SCREEN_HEADER_SIZE 4
+
+typedef struct {
+    uint16_t frame;             // número do display_update
+    uint8_t page;
+    uint8_t column;
+    uint8_t data[128];
+} telemetry_screen_t;
+
+_Static_assert(sizeof(telemetry_sensor_t) == 20, "formato do registro mudou");
+_Static_assert(sizeof(telemetry_ball_t) == 24, "formato do registro mudou");
+_Static_assert(sizeof(telemetry_frame_t) == 20, "formato do registro mudou");
+_Static_assert(sizeof(telemetry_errors_t) == 24, "formato do registro mudou");
+
+typedef struct {
+    uint32_t sent_bytes;
+    uint32_t dropped_records;
+} telemetry_stats_t;
+
+void telemetry_init(void);
+
+// Põe um registro na fila; retorna false se ele foi descartado
+bool telemetry_send(telemetry_type_t type, const void *payload, uint8_t length);
+
+// Entrega ao USB o que couber, sem esperar; chamado uma vez por quadro
+void telemetry_flush(void);
+
+// Escreve um registro direto no USB, fora do buffer e do orçamento. Antes entrega o
+// que estiver no buffer; só escreve se ele esvaziou (para não cortar um registro
+// dele ao meio) e o registro couber inteiro agora, senão retorna false
+bool telemetry_send_now(telemetry_type_t type, const void *payload, uint8_t length);
+
+telemetry_stats_t telemetry_stats(void);
+
+// CRC-16/CCITT (polinômio 0x1021, início 0xFFFF), usado também pelo decodificador
+static inline uint16_t telemetry_crc16(uint16_t crc, const uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+#endif
@@ -6,16 +6,89 @@
 #include "include/button.h"
 #include "include/display.h"
 #include "include/mpu6050.h"
+#include "include/mpu6050_calib.h"
+#include "include/physics.h"
+#include "include/occupancy.h"
+#include "include/collision.h"
+#include "include/spatial_hash.h"
+#include "include/sdf.h"
+#include "include/parallel.h"
+#include "include/fluid.h"
+#include "include/eulerian.h"
+#include "include/fusion.h"
+#include "include/joystick.h"
+#include "include/scheduler.h"
+#include "include/settings.h"
+#include "include/crc32.h"
+#include "include/replay.h"
+#include "include/replay_storage.h"
+#include "include/profiler.h"
+#include "include/telemetry.h"
 
 #define BALL_RADIUS 3
-#define GRAVITY_SENSITIVITY 0.15f
-#define DAMPING 0.95f
-#define BOUNCE_FACTOR 0.6f
+
+// número de bolas no modo bola (ex.: -DBALL_COUNT=8); a primeira a chegar vence
+#ifndef BALL_COUNT
+#define BALL_COUNT 1
+#endif
+
+// taxa de leitura do sensor e da fusão (a física roda a SCHEDULER_PHYSICS_RATE_HZ)
+#define SENSOR_RATE_HZ 100
+#define SENSOR_MAX_STEPS 4
+// sem leitura boa por mais que isso a última inclinação deixa de valer
+#define SENSOR_STALE_US 200000
 
 #define MAZE_WIDTH 16
 #define MAZE_HEIGHT 8
 #define BLOCK_SIZE 8
 
+// modo fluido: partículas e taxa de passos (cada passo custa bem mais que o da bola)
+#define FLUID_PARTICLES 300
+#define FLUID_RATE_HZ 60
+#define FLUID_MAX_STEPS 2
+
+// -DREPLAY_RECORD grava as entradas da sessão (salvas ao sair pelo botão A);
+// -DREPLAY_PLAY reproduz a última gravação da flash
+#if defined(REPLAY_RECORD) && defined(REPLAY_PLAY)
+#error "REPLAY_RECORD e REPLAY_PLAY não podem ser usados juntos"
+#endif
+
+#define REPLAY_BUFFER_SIZE (32 * 1024)
+
+// a gravação só vale para o mesmo jogo (número de bolas e tipo de colisão)
+#ifdef BALL_SWEEP_COLLISION
+#define REPLAY_BUILD_ID (BALL_COUNT | 0x100u)
+#else
+#define REPLAY_BUILD_ID BALL_COUNT
+#endif
+
+// zonas do perfil do quadro (-DPROFILER)
+enum {
+    ZONE_FRAME = PROFILER_ZONE_FRAME,
+    ZONE_SENSOR,
+    ZONE_FUSION,
+    ZONE_PHYSICS,
+    ZONE_FLUID,
+    ZONE_CLEAR,
+    ZONE_MAZE,
+    ZONE_DRAW,
+    ZONE_UPDATE,
+    ZONE_COUNT
+};
+
+#ifdef PROFILER
+static const char *const zone_names[ZONE_COUNT] = {
+    "quadro", "sensor", "fusao", "fisica", "fluido", "limpar", "labirinto", "desenho", "display",
+};
+#endif
+
+typedef enum {
+    GAME_MODE_BALL,
+    GAME_MODE_FLUID,
+    GAME_MODE_GRID_FLUID,
+    GAME_MODE_COUNT
+} game_mode;
+
 const uint8_t maze[MAZE_HEIGHT][MAZE_WIDTH] = {
     {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
     {1,0,0,0,1,0,0,0,0,0,0,0,0,0,0,1},
@@ -39,32 +112,256 @@ void draw_maze(display *disp) {
     }
 }
 
-bool check_collision(float x, float y) {
-    if (x - BALL_RADIUS < 0 || x + BALL_RADIUS > DISPLAY_WIDTH || y - BALL_RADIUS < 0 || y + BALL_RADIUS > DISPLAY_HEIGHT) {
-        return true;
-    }
-    int maze_x = (int)(x / BLOCK_SIZE);
-    int maze_y = (int)(y / BLOCK_SIZE);
-    
-    if (maze_x >= 0 && maze_x < MAZE_WIDTH && maze_y >= 0 && maze_y < MAZE_HEIGHT) {
-        if (maze[maze_y][maze_x] == 1) {
-            return true;
+// o labirinto compilado em bits: paredes para a colisão e a célula de chegada
+static uint32_t maze_wall_words[OCCUPANCY_WORDS(MAZE_WIDTH, MAZE_HEIGHT)];
+static uint32_t maze_goal_words[OCCUPANCY_WORDS(MAZE_WIDTH, MAZE_HEIGHT)];
+static occupancy_map_t maze_walls;
+static occupancy_map_t maze_goal;
+
+// campo de distância das paredes, uma amostra a cada 2 pixels (65x33 bytes)
+static int8_t maze_sdf_texels[SDF_TEXELS(MAZE_WIDTH * BLOCK_SIZE, MAZE_HEIGHT * BLOCK_SIZE, 1)];
+static sdf_t maze_sdf;
+
+// células de 2^3 = BLOCK_SIZE pixels; fora do labirinto é parede, nunca chegada
+void compile_maze(void) {
+    occupancy_init(&maze_walls, maze_wall_words, OCCUPANCY_WORDS(MAZE_WIDTH, MAZE_HEIGHT), MAZE_WIDTH, MAZE_HEIGHT, 3, true);
+    occupancy_init(&maze_goal, maze_goal_words, OCCUPANCY_WORDS(MAZE_WIDTH, MAZE_HEIGHT), MAZE_WIDTH, MAZE_HEIGHT, 3, false);
+    occupancy_from_cells(&maze_walls, &maze[0][0], 1, 0);
+    occupancy_from_cells(&maze_goal, &maze[0][0], 2, 0);
+    sdf_bake(&maze_sdf, maze_sdf_texels, sizeof(maze_sdf_texels), &maze_walls, 1);
+}
+
+// grade de vizinhança das bolas: células do labirinto (8 px >= 2 * BALL_RADIUS)
+static uint16_t ball_cell_start[MAZE_WIDTH * MAZE_HEIGHT + 1];
+static uint16_t ball_sorted[BALL_COUNT];
+static uint16_t ball_cell[BALL_COUNT];
+static spatial_hash_t ball_hash;
+
+// Coloca a bola k parada no centro da k-ésima célula livre do labirinto
+void reset_balls(physics_ball_t *balls, fix_t *previous_x, fix_t *previous_y) {
+    int k = 0;
+    for (int y = 0; y < MAZE_HEIGHT && k < BALL_COUNT; y++) {
+        for (int x = 0; x < MAZE_WIDTH && k < BALL_COUNT; x++) {
+            if (maze[y][x] != 0) continue;
+            physics_ball_reset(&balls[k], FIX_FROM_INT(x * BLOCK_SIZE + BLOCK_SIZE / 2),
+                               FIX_FROM_INT(y * BLOCK_SIZE + BLOCK_SIZE / 2));
+            previous_x[k] = balls[k].x;
+            previous_y[k] = balls[k].y;
+            k++;
         }
     }
-    return false;
 }
 
-bool check_win_condition(float x, float y) {
-    int maze_x = (int)(x / BLOCK_SIZE);
-    int maze_y = (int)(y / BLOCK_SIZE);
-    if (maze[maze_y][maze_x] == 2) {
-        return true;
-    }
-    return false;
+bool check_win_condition(fix_t x, fix_t y) {
+    return occupancy_test_point(&maze_goal, x, y);
 }
 
 display disp;
 mpu6050_t mpu;
+fluid_t fluid;
+eulerian_t grid_fluid;
+joystick_t joystick;
+replay_t replay;
+
+#ifdef REPLAY_RECORD
+static uint8_t replay_buffer[REPLAY_BUFFER_SIZE];
+#endif
+
+// Entradas do jogo: vêm do hardware (e são gravadas, se houver gravação) ou da reprodução
+bool input_poll_event(button_event *event) {
+    if (replay.mode == REPLAY_MODE_PLAY) return replay_get_button(&replay, event);
+    if (!button_poll_event(event)) return false;
+    replay_put_button(&replay, event);
+    return true;
+}
+
+uint32_t input_time_us(void) {
+    if (replay.mode == REPLAY_MODE_PLAY) return replay_get_time(&replay);
+    uint32_t now = time_us_32();
+    replay_put_time(&replay, now);
+    return now;
+}
+
+bool input_read_sensor(mpu6050_raw_data_t *raw) {
+    if (replay.mode == REPLAY_MODE_PLAY) return replay_get_sensor(&replay, raw);
+    bool ok = mpu6050_read_raw(&mpu, raw);
+    replay_put_sensor(&replay, ok, raw);
+    return ok;
+}
+
+void input_read_stick(int16_t *x, int16_t *y) {
+    if (replay.mode == REPLAY_MODE_PLAY) {
+        replay_get_stick(&replay, x, y);
+        return;
+    }
+    joystick_read(&joystick, x, y);
+    replay_put_stick(&replay, *x, *y);
+}
+
+// Resumo do estado da simulação: a gravação e a reprodução precisam terminar com o mesmo valor
+uint32_t simulation_digest(const physics_ball_t *balls) {
+    uint32_t digest = crc32(balls, BALL_COUNT * sizeof(physics_ball_t));
+    digest ^= crc32(fluid.x, fluid.count * sizeof(fix_t));
+    digest ^= crc32(fluid.y, fluid.count * sizeof(fix_t)) * 3u;
+    digest ^= crc32(grid_fluid.fill, sizeof(grid_fluid.fill)) * 5u;
+    return digest;
+}
+
+void draw_fluid(const fluid_t *fluid, display *disp) {
+    for (int i = 0; i < fluid->count; i++) {
+        display_draw_pixel(FIX_TO_INT(fluid->x[i]), FIX_TO_INT(fluid->y[i]), true, disp);
+    }
+}
+
+#ifdef TELEMETRY
+// telemetria pelo USB (-DTELEMETRY): o sensor a cada leitura, tempos e bolas a cada
+// quadro e os contadores de erro a cada segundo
+void send_sensor_telemetry(uint32_t now, const mpu6050_raw_data_t *raw) {
+    telemetry_sensor_t record = {
+        .time_us = now,
+        .accel = { raw->accel_x, raw->accel_y, raw->accel_z },
+        .gyro = { raw->gyro_x, raw->gyro_y, raw->gyro_z },
+        .temperature = raw->temperature,
+    };
+    telemetry_send(TELEMETRY_SENSOR, &record, sizeof(record));
+}
+
+void send_frame_telemetry(uint32_t now, const scheduler_t *clock, uint32_t steps, uint32_t sensor_steps,
+                          const physics_ball_t *balls, int ball_count) {
+    telemetry_frame_t frame = {
+        .time_us = now,
+        .frame_us = clock->last_frame_us,
+        .physics_steps = (uint16_t)steps,
+        .sensor_steps = (uint16_t)sensor_steps,
+        .missed_deadlines = clock->missed_deadlines,
+        .dropped_records = telemetry_stats().dropped_records,
+    };
+    telemetry_send(TELEMETRY_FRAME, &frame, sizeof(frame));
+
+    for (int k = 0; k < ball_count; k++) {
+        telemetry_ball_t ball = {
+            .time_us = now,
+            .x = balls[k].x,
+            .y = balls[k].y,
+            .vel_x = balls[k].vel_x,
+            .vel_y = balls[k].vel_y,
+            .index = (uint16_t)k,
+        };
+        telemetry_send(TELEMETRY_BALL, &ball, sizeof(ball));
+    }
+}
+
+void send_error_telemetry(uint32_t now, uint32_t sensor_errors) {
+    i2c_bus_stats_t sensor_bus = mpu6050_i2c_stats();
+    i2c_bus_stats_t display_bus = display_i2c_stats();
+    telemetry_errors_t errors = {
+        .time_us = now,
+        .sensor_errors = sensor_errors,
+        .display_errors = display_bus.errors,
+        .button_dropped = button_dropped_events(),
+        .sensor_timeouts = (uint16_t)sensor_bus.timeouts,
+        .sensor_recoveries = (uint16_t)sensor_bus.recoveries,
+        .display_timeouts = (uint16_t)display_bus.timeouts,
+        .display_recoveries = (uint16_t)display_bus.recoveries,
+    };
+    telemetry_send(TELEMETRY_ERRORS, &errors, sizeof(errors));
+}
+#endif
+
+#ifdef FLUID_BENCHMARK
+// passo do fluido com 1 e 2 núcleos, e o quadro completo (passo + desenho + envio ao display)
+void run_fluid_benchmark(void) {
+    printf("particulas  1 nucleo (us/passo)  2 nucleos (us/passo)  quadro (fps)\n");
+    for (int count = 64; count <= FLUID_MAX_PARTICLES; count += 64) {
+        parallel_set_cores(1);
+        uint32_t single_us = fluid_benchmark_step_us(&fluid, &maze_sdf, count, 32);
+        parallel_set_cores(2);
+        uint32_t dual_us = fluid_benchmark_step_us(&fluid, &maze_sdf, count, 32);
+
+        uint64_t start = time_us_64();
+        for (int i = 0; i < 16; i++) {
+            fluid_step(&fluid, 0, FIX_ONE);
+            display_clear(&disp);
+            draw_maze(&disp);
+            draw_fluid(&fluid, &disp);
+            display_update(&disp);
+        }
+        uint32_t frame_us = (uint32_t)((time_us_64() - start) / 16);
+
+        printf("%10d  %19lu  %20lu  %12lu\n", fluid.count, (unsigned long)single_us,
+               (unsigned long)dual_us, (unsigned long)(1000000 / frame_us));
+    }
+
+    parallel_set_cores(1);
+    uint32_t grid_single_us = eulerian_benchmark_step_us(&grid_fluid, &maze_walls, 32);
+    parallel_set_cores(2);
+    uint32_t grid_dual_us = eulerian_benchmark_step_us(&grid_fluid, &maze_walls, 32);
+    printf("grade %dx%d (%u bytes): %lu us/passo com 1 nucleo, %lu us/passo com 2\n",
+           EULERIAN_WIDTH, EULERIAN_HEIGHT, (unsigned)sizeof(eulerian_t),
+           (unsigned long)grid_single_us, (unsigned long)grid_dual_us);
+}
+#endif
+
+#ifdef I2C_BENCHMARK
+// envio ao display em cada clock do I2C: a tela inteira e uma bola andando pelo
+// labirinto (só os trechos alterados), e uma leitura do sensor até o clock dele
+void run_i2c_benchmark(void) {
+#if defined(DISPLAY_SPI)
+    static const uint32_t rates[] = {1000 * 1000, 4000 * 1000, 8000 * 1000, 10000 * 1000, 16000 * 1000,
+                                     20000 * 1000};
+#elif defined(DISPLAY_PIO_I2C)
+    static const uint32_t rates[] = {100 * 1000, 400 * 1000, 600 * 1000, 800 * 1000, 1000 * 1000,
+                                     1500 * 1000, 2000 * 1000};
+#else
+    static const uint32_t rates[] = {100 * 1000, 400 * 1000, 600 * 1000, 800 * 1000, 1000 * 1000};
+#endif
+    uint32_t display_rate = display_get_baudrate();
+    uint32_t sensor_rate = mpu.baudrate ? mpu.baudrate : MPU6050_I2C_BAUDRATE;
+
+    printf("clock (Hz)  obtido (Hz)  tela inteira (fps)  bola (fps)  sensor (us)  erros\n");
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        // acima do teto (no SPI, o limite do datasheet) só se ele for aumentado na compilação
+        if (rates[i] > DISPLAY_MAX_BAUDRATE) break;
+        uint32_t actual = display_set_baudrate(&disp, rates[i]);
+        uint32_t errors = display_error_count();
+
+        uint64_t start = time_us_64();
+        for (int frame = 0; frame < 16; frame++) {
+            display_invalidate();
+            display_update(&disp);
+        }
+        display_flush();
+        uint32_t full_us = (uint32_t)((time_us_64() - start) / 16);
+
+        start = time_us_64();
+        for (int frame = 0; frame < 16; frame++) {
+            display_clear(&disp);
+            draw_maze(&disp);
+            display_draw_circle(8 + frame * 4, DISPLAY_HEIGHT / 2, 2, true, true, &disp);
+            display_update(&disp);
+        }
+        display_flush();
+        uint32_t ball_us = (uint32_t)((time_us_64() - start) / 16);
+
+        // o sensor só vai até o máximo configurado para ele
+        long sensor_us = -1;
+        if (rates[i] <= MPU6050_I2C_MAX_BAUDRATE) {
+            mpu6050_set_baudrate(&mpu, rates[i]);
+            mpu6050_raw_data_t raw;
+            start = time_us_64();
+            for (int read = 0; read < 64; read++) mpu6050_read_raw(&mpu, &raw);
+            sensor_us = (long)((time_us_64() - start) / 64);
+        }
+
+        printf("%10lu  %11lu  %18lu  %10lu  %11ld  %5lu\n", (unsigned long)rates[i], (unsigned long)actual,
+               (unsigned long)(1000000 / full_us), (unsigned long)(1000000 / ball_us), sensor_us,
+               (unsigned long)(display_error_count() - errors));
+    }
+
+    display_set_baudrate(&disp, display_rate);
+    mpu6050_set_baudrate(&mpu, sensor_rate);
+}
+#endif
 
 int main() {
     stdio_init_all();
@@ -72,32 +369,219 @@ int main() {
 
     display_init(&disp);
     button_init();
+    compile_maze();
+
+    // o núcleo 1 ajuda no fluido; precisa subir antes de qualquer gravação na flash
+    parallel_init();
     
     if (!mpu6050_init(&mpu)) {
         display_draw_string(5, 20, "MPU6050 FALHOU!", true, &disp);
         display_update(&disp);
         while(1);
     }
-    mpu6050_calibrate(&mpu, 1000);
+
+#ifdef I2C_AUTO_PROBE
+    // sobe o clock dos dois barramentos até onde as transferências continuarem certas
+    uint32_t display_rate = display_probe_baudrate(&disp, DISPLAY_MAX_BAUDRATE);
+    uint32_t sensor_rate = mpu6050_probe_baudrate(&mpu, MPU6050_I2C_MAX_BAUDRATE);
+    printf("i2c: display a %lu Hz, sensor a %lu Hz\n", (unsigned long)display_rate, (unsigned long)sensor_rate);
+#endif
+
+    // a correção de offsets é feita pelo próprio sensor, sem custo por leitura
+    mpu6050_set_hw_offsets(&mpu, true);
+
+    // usa os offsets gravados na flash; sem eles (ou com escalas diferentes)
+    // a calibração acontece em segundo plano, com o jogo já rodando
+    mpu6050_calib_t calib;
+    mpu6050_calib_init(&calib, MPU6050_CALIB_WINDOW);
+
+    settings_t settings;
+    bool calibrating = true;
+    if (settings_load(&settings) &&
+        settings.accel_scale == mpu.accel_scale && settings.gyro_scale == mpu.gyro_scale) {
+        mpu6050_set_offsets(&mpu, &settings.offsets);
+        calibrating = false;
+    }
     
-    float ball_x = 12.0f, ball_y = 12.0f;
-    float vel_x = 0.0f, vel_y = 0.0f;
+#ifdef FUSION_BENCHMARK
+    printf("fusion complementar: %lu ciclos/update\n", (unsigned long)fusion_benchmark_cycles(FUSION_COMPLEMENTARY, 1000));
+    printf("fusion madgwick: %lu ciclos/update\n", (unsigned long)fusion_benchmark_cycles(FUSION_MADGWICK, 1000));
+#endif
+
+#ifdef FLUID_BENCHMARK
+    run_fluid_benchmark();
+#endif
+
+#ifdef I2C_BENCHMARK
+    run_i2c_benchmark();
+#endif
+
+    // a inclinação vem do vetor gravidade filtrado, e não do acelerômetro cru
+    fusion_t fusion;
+    fusion_init(&fusion, FUSION_COMPLEMENTARY, &mpu, SENSOR_RATE_HZ);
+
+    // o joystick analógico pode substituir a inclinação (alternado pelo botão do joystick)
+    bool use_joystick = false;
+    bool joystick_available = joystick_init(&joystick);
+    bool joystick_long_press = false;
+
+#ifdef REPLAY_PLAY
+    // sem gravação compatível não há o que reproduzir
+    const uint8_t *replay_data;
+    uint32_t replay_length;
+    if (!replay_storage_load(&replay_data, &replay_length) ||
+        !replay_play_start(&replay, replay_data, replay_length) ||
+        replay.header.build_id != REPLAY_BUILD_ID ||
+        replay.header.accel_scale != mpu.accel_scale || replay.header.gyro_scale != mpu.gyro_scale) {
+        display_clear(&disp);
+        display_draw_string(5, 20, "SEM GRAVACAO", true, &disp);
+        display_update(&disp);
+        while (1);
+    }
+    // a calibração mexeria no sensor de verdade; as leituras gravadas já vêm corrigidas
+    calibrating = false;
+    joystick_available = (replay.header.flags & REPLAY_FLAG_JOYSTICK) != 0;
+    printf("replay: %lu bytes\n", (unsigned long)replay_length);
+#endif
+
+#ifdef REPLAY_RECORD
+    replay_header_t replay_header = {
+        .build_id = REPLAY_BUILD_ID,
+        .accel_scale = mpu.accel_scale,
+        .gyro_scale = mpu.gyro_scale,
+        .flags = joystick_available ? REPLAY_FLAG_JOYSTICK : 0,
+    };
+    replay_record_start(&replay, replay_buffer, sizeof(replay_buffer), &replay_header);
+#endif
+
+    // física em passo fixo, independente de quanto demora cada quadro
+    scheduler_t physics_clock;
+    scheduler_init(&physics_clock, SCHEDULER_PHYSICS_RATE_HZ, SCHEDULER_MAX_STEPS);
+    scheduler_t sensor_clock;
+    scheduler_init(&sensor_clock, SENSOR_RATE_HZ, SENSOR_MAX_STEPS);
+
+    physics_config_t physics;
+    physics_config_for_step(&physics, physics_clock.step_us);
+
+    physics_ball_t balls[BALL_COUNT];
+    fix_t previous_x[BALL_COUNT], previous_y[BALL_COUNT];
+    reset_balls(balls, previous_x, previous_y);
+    spatial_hash_init(&ball_hash, ball_cell_start, ball_sorted, ball_cell, BALL_COUNT, MAZE_WIDTH, MAZE_HEIGHT, 3);
     bool game_won = false;
 
-    while (1) {
-        button_event event = button_get_event();
-        if (event != BUTTON_NONE) {
-            if (event == BUTTON_A) {
-                display_shutdown(&disp);
-                reset_usb_boot(0, 0);
+    // segurar o botão B alterna entre a bola, o fluido de partículas e o fluido em grade
+    game_mode mode = GAME_MODE_BALL;
+    bool b_long_press = false;
+    scheduler_t fluid_clock;
+    scheduler_init(&fluid_clock, FLUID_RATE_HZ, FLUID_MAX_STEPS);
+
+#ifdef SCHEDULER_REPORT
+    uint32_t report_time_us = time_us_32();
+#endif
+
+#ifdef PROFILER
+    profiler_init(zone_names, ZONE_COUNT);
+#endif
+
+#ifdef TELEMETRY
+    telemetry_init();
+    uint32_t sensor_errors = 0;
+    uint32_t telemetry_errors_time_us = time_us_32();
+#endif
+
+    // um sensor que parou de responder não pode continuar empurrando a bola com a
+    // inclinação de antes: passado SENSOR_STALE_US ela fica nivelada até ele voltar
+    // (o driver tenta recuperar o barramento sozinho); antes da primeira leitura a
+    // fusão já começa nivelada
+    uint32_t sensor_ok_time_us = 0;
+    bool sensor_seen = false;
+
+    // a gravação encheu o buffer: o fluxo fica encerrado, mas o modo continua de
+    // gravação para o botão A ainda salvar o que coube
+    bool replay_full = false;
+
+    bool running = true;
+    while (running) {
+        // fim da reprodução, ou gravação sem espaço para mais um quadro
+        if (replay.mode != REPLAY_MODE_OFF && !replay_full && !replay_frame(&replay)) {
+            if (replay.mode == REPLAY_MODE_PLAY) break;
+            replay_full = true;
+            printf("replay: buffer cheio em %lu quadros, estado %08lx\n",
+                   (unsigned long)replay.frames, (unsigned long)simulation_digest(balls));
+        }
+
+        PROFILE_FRAME();
+        PROFILE_POLL();
+
+#ifdef TELEMETRY
+        // o que o quadro anterior produziu
+        telemetry_flush();
+#endif
+
+        // processa todos os eventos acumulados desde o último quadro
+        button_event event;
+        while (running && input_poll_event(&event)) {
+            if (event.button == BUTTON_JOYSTICK) {
+                if (event.action == BUTTON_LONG_PRESS) {
+                    // segurar: recalibração sob demanda
+                    mpu6050_calib_init(&calib, MPU6050_CALIB_WINDOW);
+                    calibrating = true;
+                    joystick_long_press = true;
+                } else if (event.action == BUTTON_RELEASE) {
+                    // clique curto: alterna entre sensor de movimento e joystick
+                    if (!joystick_long_press && joystick_available) use_joystick = !use_joystick;
+                    joystick_long_press = false;
+                }
+                continue;
             }
-            if (event == BUTTON_B) {
-                ball_x = 12.0f; ball_y = 12.0f;
-                vel_x = 0.0f; vel_y = 0.0f;
+
+            if (event.button == BUTTON_B) {
+                if (event.action == BUTTON_LONG_PRESS) {
+                    // segurar: troca de modo
+                    mode = (game_mode)((mode + 1) % GAME_MODE_COUNT);
+                    b_long_press = true;
+                } else if (event.action != BUTTON_RELEASE) {
+                    continue;
+                } else if (b_long_press) {
+                    b_long_press = false;
+                    continue;
+                }
+
+                // clique curto (ou troca de modo): recomeça o modo atual
+                reset_balls(balls, previous_x, previous_y);
                 game_won = false;
+                if (mode == GAME_MODE_FLUID) fluid_init(&fluid, &maze_sdf, FLUID_PARTICLES);
+                if (mode == GAME_MODE_GRID_FLUID) eulerian_init(&grid_fluid, &maze_walls);
+                // o tempo parado na tela de vitória não conta para a simulação
+                scheduler_restart(&physics_clock);
+                scheduler_restart(&sensor_clock);
+                scheduler_restart(&fluid_clock);
+                continue;
+            }
+
+            if (event.action != BUTTON_PRESS) continue;
+
+            if (event.button == BUTTON_A) {
+                // na reprodução, o botão A gravado encerra a sessão
+                if (replay.mode == REPLAY_MODE_PLAY) {
+                    running = false;
+                    break;
+                }
+                if (replay.mode == REPLAY_MODE_RECORD) {
+                    replay_stop(&replay);
+                    // com o buffer cheio, o estado que vale é o já mostrado quando ele encheu
+                    if (!replay_full) {
+                        printf("replay: %lu quadros, estado %08lx\n",
+                               (unsigned long)replay.frames, (unsigned long)simulation_digest(balls));
+                    }
+                    replay_storage_save(&replay);
+                    replay_storage_dump(&replay);
+                }
+                display_shutdown(&disp);
+                reset_usb_boot(0, 0);
             }
-            button_clear_event();
         }
+        if (!running) break;
 
         if (game_won) {
             display_clear(&disp);
@@ -109,44 +593,156 @@ int main() {
             continue;
         }
 
-        mpu6050_data_t sensor_data;
-        mpu6050_read_data(&mpu, &sensor_data);
+        uint32_t now = input_time_us();
+
+        // o sensor é lido uma vez por quadro, e a fusão avança em passos fixos
+        uint32_t sensor_steps = scheduler_begin_frame(&sensor_clock, now);
+        mpu6050_raw_data_t sensor_raw;
+        bool sensor_ok = false;
+        PROFILE_ZONE(ZONE_SENSOR) sensor_ok = sensor_steps > 0 && input_read_sensor(&sensor_raw);
+        if (sensor_ok) {
+            sensor_ok_time_us = now;
+            sensor_seen = true;
+            PROFILE_ZONE(ZONE_FUSION) {
+                for (uint32_t i = 0; i < sensor_steps; i++) {
+                    fusion_update(&fusion, &sensor_raw);
+                }
+            }
 
-        vel_x += sensor_data.accel_x_g * GRAVITY_SENSITIVITY;
-        vel_y -= sensor_data.accel_y_g * GRAVITY_SENSITIVITY;
+            if (calibrating && replay.mode != REPLAY_MODE_PLAY && mpu6050_calib_update(&calib, &mpu, &sensor_raw) && mpu6050_calib_is_converged(&calib)) {
+                mpu6050_get_offsets(&mpu, &settings.offsets);
+                settings.accel_scale = mpu.accel_scale;
+                settings.gyro_scale = mpu.gyro_scale;
+                settings_save(&settings);
+                calibrating = false;
+            }
+        }
 
-        vel_x *= DAMPING;
-        vel_y *= DAMPING;
+#ifdef TELEMETRY
+        if (sensor_ok) {
+            send_sensor_telemetry(now, &sensor_raw);
+        } else if (sensor_steps > 0) {
+            sensor_errors++;
+        }
+        if (now - telemetry_errors_time_us >= 1000000) {
+            send_error_telemetry(now, sensor_errors);
+            telemetry_errors_time_us = now;
+        }
+#endif
 
-        float next_x = ball_x + vel_x;
-        float next_y = ball_y + vel_y;
+        float gravity_x, gravity_y, gravity_z;
+        fusion_get_gravity(&fusion, &gravity_x, &gravity_y, &gravity_z);
 
-        if (check_collision(next_x, ball_y)) {
-            vel_x = -vel_x * BOUNCE_FACTOR;
-        } else {
-            ball_x = next_x;
+        fix_t accel_x = FIX_FROM_FLOAT(gravity_x);
+        fix_t accel_y = FIX_FROM_FLOAT(gravity_y);
+        if (sensor_seen && now - sensor_ok_time_us > SENSOR_STALE_US) {
+            accel_x = 0;
+            accel_y = 0;
         }
 
-        if (check_collision(ball_x, next_y)) {
-            vel_y = -vel_y * BOUNCE_FACTOR;
-        } else {
-            ball_y = next_y;
+        if (use_joystick) {
+            // a deflexão máxima vale 1g, na mesma escala do acelerômetro em ±2g
+            int16_t stick_x, stick_y;
+            input_read_stick(&stick_x, &stick_y);
+            accel_x = physics_accel_from_raw(stick_x, PHYSICS_ACCEL_SHIFT_2G);
+            accel_y = physics_accel_from_raw(stick_y, PHYSICS_ACCEL_SHIFT_2G);
         }
-        
-        if(check_win_condition(ball_x, ball_y)) {
-            game_won = true;
+
+        if (mode != GAME_MODE_BALL) {
+            uint32_t fluid_steps = scheduler_begin_frame(&fluid_clock, now);
+            PROFILE_ZONE(ZONE_FLUID) {
+                for (uint32_t i = 0; i < fluid_steps; i++) {
+                    if (mode == GAME_MODE_FLUID) {
+                        fluid_step(&fluid, accel_x, -accel_y);
+                    } else {
+                        eulerian_step(&grid_fluid, accel_x, -accel_y);
+                    }
+                }
+            }
+
+            PROFILE_ZONE(ZONE_CLEAR) display_clear(&disp);
+            PROFILE_ZONE(ZONE_MAZE) draw_maze(&disp);
+            PROFILE_ZONE(ZONE_DRAW) {
+                if (mode == GAME_MODE_FLUID) {
+                    draw_fluid(&fluid, &disp);
+                } else {
+                    eulerian_render(&grid_fluid, &disp);
+                }
+            }
+            PROFILE_ZONE(ZONE_UPDATE) display_update(&disp);
+#ifdef TELEMETRY
+            send_frame_telemetry(now, &fluid_clock, fluid_steps, sensor_steps, NULL, 0);
+#endif
+            continue;
         }
 
-        display_clear(&disp);
+        uint32_t steps = scheduler_begin_frame(&physics_clock, now);
+        PROFILE_ZONE(ZONE_PHYSICS) {
+            for (uint32_t i = 0; i < steps && !game_won; i++) {
+                for (int k = 0; k < BALL_COUNT; k++) {
+                    physics_ball_t *ball = &balls[k];
+                    previous_x[k] = ball->x;
+                    previous_y[k] = ball->y;
+
+                    // o eixo y do sensor é invertido em relação ao eixo y da tela
+                    physics_ball_accelerate(ball, &physics, accel_x, -accel_y);
+#ifdef BALL_SWEEP_COLLISION
+                    collision_move_ball(&maze_walls, ball, FIX_FROM_INT(BALL_RADIUS), physics.bounce);
+#else
+                    sdf_move_ball(&maze_sdf, ball, FIX_FROM_INT(BALL_RADIUS), physics.bounce);
+#endif
+                }
+
+                // choques entre as bolas; as paredes corrigem no próximo passo
+                collision_balls(balls, BALL_COUNT, FIX_FROM_INT(BALL_RADIUS), physics.bounce, &ball_hash);
+
+                for (int k = 0; k < BALL_COUNT; k++) {
+                    if (check_win_condition(balls[k].x, balls[k].y)) {
+                        game_won = true;
+                    }
+                }
+            }
+        }
+
+#ifdef TELEMETRY
+        send_frame_telemetry(now, &physics_clock, steps, sensor_steps, balls, BALL_COUNT);
+#endif
+
+        // desenha entre os dois últimos passos, conforme o tempo que sobrou no acumulador
+        fix_t alpha = scheduler_alpha(&physics_clock);
+
+        PROFILE_ZONE(ZONE_CLEAR) display_clear(&disp);
         
-        draw_maze(&disp);
+        PROFILE_ZONE(ZONE_MAZE) draw_maze(&disp);
         
-        display_draw_circle((int)ball_x, (int)ball_y, BALL_RADIUS, true, true, &disp);
+        PROFILE_ZONE(ZONE_DRAW) {
+            for (int k = 0; k < BALL_COUNT; k++) {
+                fix_t draw_x = scheduler_lerp(previous_x[k], balls[k].x, alpha);
+                fix_t draw_y = scheduler_lerp(previous_y[k], balls[k].y, alpha);
+                display_draw_circle(FIX_TO_INT(draw_x), FIX_TO_INT(draw_y), BALL_RADIUS, true, true, &disp);
+            }
+        }
         
-        display_update(&disp);
+        PROFILE_ZONE(ZONE_UPDATE) display_update(&disp);
 
-        sleep_ms(10); 
+#ifdef SCHEDULER_REPORT
+        if (now - report_time_us >= 1000000) {
+            printf("quadros: %lu passos: %lu atrasos: %lu (%lu us descartados) quadro max: %lu us\n",
+                   (unsigned long)physics_clock.frames, (unsigned long)physics_clock.steps,
+                   (unsigned long)physics_clock.missed_deadlines, (unsigned long)physics_clock.dropped_us,
+                   (unsigned long)physics_clock.max_frame_us);
+            scheduler_reset_stats(&physics_clock);
+            report_time_us = now;
+        }
+#endif
     }
 
+    // fim da reprodução: o estado deve ser o mesmo impresso no fim da gravação
+    printf("replay: %lu quadros, estado %08lx%s\n", (unsigned long)replay.frames,
+           (unsigned long)simulation_digest(balls), replay.desync ? " (dessincronizado)" : "");
+    display_clear(&disp);
+    display_draw_string(5, 20, replay.desync ? "REPLAY ERRO" : "REPLAY FIM", true, &disp);
+    display_update(&disp);
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+/*
+* Benchmark da diferença entre quadros no computador (não roda na placa)
+* Para algumas cenas típicas, mede o custo de framebuffer_diff (contra a
+* comparação byte a byte) e quantos bytes vão pelo I2C e pelo USB com os
+* trechos, comparado com mandar a tela inteira.
+*
+* gcc -O2 -Iinclude tools/framebuffer_diff_bench.c include/framebuffer_diff.c -o framebuffer_diff_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "framebuffer_diff.h"
+
+#define FRAMES 2000
+#define REPEAT 50
+
+// custo fixo de cada trecho, como em display.c e screen_mirror.c
+#define I2C_SPAN_OVERHEAD 10
+#define USB_SPAN_OVERHEAD 12
+// a atualização inteira antiga: 3 comandos de 3 bytes e 130 bytes de dados por página
+#define I2C_FULL_BYTES (FRAMEBUFFER_PAGES * (3 * 3 + DISPLAY_WIDTH + 2))
+
+static uint8_t frames[FRAMES][FRAMEBUFFER_SIZE] __attribute__((aligned(4)));
+
+static double now_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static void set_pixel(uint8_t *frame, int x, int y) {
+    if (x < 0 || x >= DISPLAY_WIDTH || y < 0 || y >= DISPLAY_HEIGHT) return;
+    frame[(y / 8) * DISPLAY_WIDTH + x] |= (uint8_t)(1 << (y % 8));
+}
+
+static void fill_disc(uint8_t *frame, int cx, int cy, int radius) {
+    for (int y = -radius; y <= radius; y++) {
+        for (int x = -radius; x <= radius; x++) {
+            if (x * x + y * y <= radius * radius) set_pixel(frame, cx + x, cy + y);
+        }
+    }
+}
+
+// labirinto fixo: bordas e algumas paredes
+static void draw_maze(uint8_t *frame) {
+    for (int x = 0; x < DISPLAY_WIDTH; x++) {
+        set_pixel(frame, x, 0);
+        set_pixel(frame, x, DISPLAY_HEIGHT - 1);
+    }
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        set_pixel(frame, 0, y);
+        set_pixel(frame, DISPLAY_WIDTH - 1, y);
+        if (y < 40) set_pixel(frame, 40, y);
+        if (y > 24) set_pixel(frame, 88, y);
+    }
+}
+
+// uma bola andando sobre o labirinto
+static void scene_ball(int frame_index, uint8_t *frame) {
+    draw_maze(frame);
+    int t = frame_index % 200;
+    fill_disc(frame, 10 + (t < 100 ? t : 200 - t), 32 + (frame_index / 7) % 20 - 10, 3);
+}
+
+// várias bolas espalhadas (trechos em muitas páginas)
+static void scene_balls(int frame_index, uint8_t *frame) {
+    draw_maze(frame);
+    for (int i = 0; i < 8; i++) {
+        int x = (i * 37 + frame_index * (1 + i % 3)) % DISPLAY_WIDTH;
+        int y = (i * 23 + frame_index * (1 + i % 2)) % DISPLAY_HEIGHT;
+        fill_disc(frame, x, y, 2);
+    }
+}
+
+// centenas de partículas do modo de fluido
+static void scene_fluid(int frame_index, uint8_t *frame) {
+    srand(1234);
+    for (int i = 0; i < 400; i++) {
+        int x = rand() % DISPLAY_WIDTH;
+        int y = DISPLAY_HEIGHT - 1 - rand() % 24;
+        int jitter = (frame_index + i) % 3 - 1;
+        set_pixel(frame, x + jitter, y);
+    }
+}
+
+// ruído: tudo muda em todo quadro (o pior caso)
+static void scene_noise(int frame_index, uint8_t *frame) {
+    srand((unsigned)frame_index);
+    for (int i = 0; i < FRAMEBUFFER_SIZE; i++) frame[i] = (uint8_t)rand();
+}
+
+static const struct {
+    const char *name;
+    void (*draw)(int frame_index, uint8_t *frame);
+} scenes[] = {
+    { "bola", scene_ball },
+    { "8 bolas", scene_balls },
+    { "fluido", scene_fluid },
+    { "ruido", scene_noise },
+};
+
+// referência: a mesma busca de trechos, byte a byte
+static int bytewise_diff(const uint8_t *current, const uint8_t *previous, int merge_gap,
+                         framebuffer_span_t *spans) {
+    int count = 0;
+    for (int page = 0; page < FRAMEBUFFER_PAGES; page++) {
+        int page_first = count;
+        for (int column = 0; column < DISPLAY_WIDTH; column++) {
+            int i = page * DISPLAY_WIDTH + column;
+            if (current[i] == previous[i]) continue;
+            framebuffer_span_t *last = count > page_first ? &spans[count - 1] : NULL;
+            if (last && (column - last->end - 1 <= merge_gap ||
+                         count - page_first == FRAMEBUFFER_MAX_SPANS_PER_PAGE)) {
+                last->end = (uint8_t)column;
+            } else {
+                spans[count++] = (framebuffer_span_t){ (uint8_t)page, (uint8_t)column, (uint8_t)column };
+            }
+        }
+    }
+    return count;
+}
+
+static int span_bytes(const framebuffer_span_t *spans, int count, int overhead) {
+    int total = 0;
+    for (int i = 0; i < count; i++) total += overhead + framebuffer_span_length(&spans[i]);
+    return total;
+}
+
+static double time_diff(int (*diff)(const uint8_t *, const uint8_t *, int, framebuffer_span_t *)) {
+    framebuffer_span_t spans[FRAMEBUFFER_MAX_SPANS];
+    volatile int sink = 0;
+    double start = now_us();
+    for (int r = 0; r < REPEAT; r++) {
+        for (int f = 1; f < FRAMES; f++) sink += diff(frames[f], frames[f - 1], I2C_SPAN_OVERHEAD, spans);
+    }
+    (void)sink;
+    return (now_us() - start) * 1000.0 / (REPEAT * (FRAMES - 1));
+}
+
+int main(void) {
+    printf("%d quadros por cena; tela inteira = %d bytes no I2C, %d no USB\n\n", FRAMES, I2C_FULL_BYTES,
+           FRAMEBUFFER_PAGES * (USB_SPAN_OVERHEAD + DISPLAY_WIDTH));
+    printf("cena       palavras ns  bytes ns  trechos  I2C bytes  economia  USB bytes  economia\n");
+
+    for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++) {
+        memset(frames, 0, sizeof(frames));
+        for (int f = 0; f < FRAMES; f++) scenes[s].draw(f, frames[f]);
+
+        // as duas versões precisam achar os mesmos trechos
+        framebuffer_span_t a[FRAMEBUFFER_MAX_SPANS], b[FRAMEBUFFER_MAX_SPANS];
+        long spans = 0, i2c = 0, usb = 0;
+        for (int f = 1; f < FRAMES; f++) {
+            int count = framebuffer_diff(frames[f], frames[f - 1], I2C_SPAN_OVERHEAD, a);
+            int reference = bytewise_diff(frames[f], frames[f - 1], I2C_SPAN_OVERHEAD, b);
+            if (count != reference || memcmp(a, b, count * sizeof(a[0])) != 0) {
+                printf("ERRO: %s quadro %d difere da referência\n", scenes[s].name, f);
+                return 1;
+            }
+            spans += count;
+            i2c += span_bytes(a, count, I2C_SPAN_OVERHEAD);
+            usb += span_bytes(a, framebuffer_diff(frames[f], frames[f - 1], USB_SPAN_OVERHEAD, a), USB_SPAN_OVERHEAD);
+        }
+
+        double words_ns = time_diff(framebuffer_diff);
+        double bytes_ns = time_diff(bytewise_diff);
+        double i2c_frame = (double)i2c / (FRAMES - 1);
+        double usb_frame = (double)usb / (FRAMES - 1);
+        int usb_full = FRAMEBUFFER_PAGES * (USB_SPAN_OVERHEAD + DISPLAY_WIDTH);
+        printf("%-9s %11.0f %9.0f %8.1f %10.0f %8.0f%% %10.0f %8.0f%%\n", scenes[s].name, words_ns, bytes_ns,
+               (double)spans / (FRAMES - 1), i2c_frame, 100.0 * (1.0 - i2c_frame / I2C_FULL_BYTES),
+               usb_frame, 100.0 * (1.0 - usb_frame / usb_full));
+    }
+    return 0;
+}
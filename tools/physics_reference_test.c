@@ -0,0 +1,177 @@
+/*
+* Confere a física em ponto fixo contra a versão em float (não roda na placa)
+* Integra a mesma bola, com as mesmas leituras do acelerômetro, nas duas
+* aritméticas no passo fixo do jogo (500 Hz), dentro de uma caixa do tamanho
+* da tela, e falha se a trajetória em ponto fixo se afastar da de referência.
+* A cada segundo a bola em ponto fixo volta para o estado da referência: em
+* Q.16 a velocidade só muda alguns LSB por passo, então as duas se separam aos
+* poucos mesmo sem erro nenhum, e o que importa é quanto isso anda por segundo.
+*
+* gcc -O2 -Iinclude tools/physics_reference_test.c include/physics.c -lm -o physics_reference_test
+* (ou com -DPHYSICS_FRAC_BITS=20 para conferir outro formato)
+*/
+#include <math.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "physics.h"
+
+#define STEP_US 2000
+#define SECONDS 20
+#define STEPS (SECONDS * 1000000 / STEP_US)
+
+// caixa da tela (128x64) descontando o raio da bola
+#define BOX_MIN 3.0f
+#define BOX_MAX_X 124.0f
+#define BOX_MAX_Y 60.0f
+
+// a cada WINDOW passos (1 s) o ponto fixo recomeça do estado da referência
+#define WINDOW 500
+
+// afastamento máximo aceito dentro de uma janela, em pixels (a bola tem raio 3)
+#define TOLERANCE_PX 1.0f
+
+// versão em float: as mesmas contas de physics.c, sem arredondamento
+typedef struct {
+    float x, y, vel_x, vel_y;
+} reference_ball_t;
+
+typedef struct {
+    float gravity, damping, bounce;
+} reference_config_t;
+
+static void reference_config_for_step(reference_config_t *config, uint32_t step_us) {
+    float k = (float)PHYSICS_REF_STEP_US / (float)step_us;
+    config->gravity = PHYSICS_GRAVITY_SENSITIVITY / (k * k);
+    config->damping = powf(PHYSICS_DAMPING, 1.0f / k);
+    config->bounce = PHYSICS_BOUNCE_FACTOR;
+}
+
+// um eixo: anda se couber na caixa, senão volta com parte da velocidade
+static void reference_move(float *pos, float *vel, float bounce, float max) {
+    float next = *pos + *vel;
+    if (next < BOX_MIN || next > max) {
+        *vel = -*vel * bounce;
+    } else {
+        *pos = next;
+    }
+}
+
+static void fixed_move(fix_t *pos, fix_t *vel, fix_t bounce, float max) {
+    fix_t next = *pos + *vel;
+    if (next < FIX_FROM_FLOAT(BOX_MIN) || next > FIX_FROM_FLOAT(max)) {
+        *vel = -fix_mul(*vel, bounce);
+    } else {
+        *pos = next;
+    }
+}
+
+// perfis de inclinação em LSB do acelerômetro (±2g, 16384 LSB/g)
+typedef struct {
+    const char *name;
+    void (*accel)(int step, int16_t *raw_x, int16_t *raw_y);
+} profile_t;
+
+static void profile_still(int step, int16_t *raw_x, int16_t *raw_y) {
+    (void)step;
+    *raw_x = 0;
+    *raw_y = 0;
+}
+
+static void profile_tilt(int step, int16_t *raw_x, int16_t *raw_y) {
+    (void)step;
+    *raw_x = 2900;   // ~10 graus
+    *raw_y = -1400;
+}
+
+static void profile_gentle(int step, int16_t *raw_x, int16_t *raw_y) {
+    // inclinação pequena, perto de onde o arredondamento pesa mais
+    *raw_x = (step / 1000) % 2 ? 300 : -300;
+    *raw_y = 120;
+}
+
+static void profile_swing(int step, int16_t *raw_x, int16_t *raw_y) {
+    float t = (float)step * STEP_US / 1e6f;
+    *raw_x = (int16_t)(9000.0f * sinf(t * 1.3f));
+    *raw_y = (int16_t)(6000.0f * cosf(t * 0.7f));
+}
+
+static void profile_noise(int step, int16_t *raw_x, int16_t *raw_y) {
+    // o mesmo gerador para as duas versões: a leitura é a mesma, só a conta muda
+    static uint32_t state;
+    if (step == 0) state = 12345;
+    state = state * 1664525u + 1013904223u;
+    *raw_x = (int16_t)(4000 + (int)((state >> 16) & 0x3FF) - 512);
+    state = state * 1664525u + 1013904223u;
+    *raw_y = (int16_t)(-2500 + (int)((state >> 16) & 0x3FF) - 512);
+}
+
+static const profile_t profiles[] = {
+    {"parada", profile_still},
+    {"inclinada", profile_tilt},
+    {"suave", profile_gentle},
+    {"balanco", profile_swing},
+    {"ruido", profile_noise},
+};
+
+#define PROFILE_COUNT (sizeof(profiles) / sizeof(profiles[0]))
+
+// roda um perfil; retorna o maior afastamento em pixels
+static float run_profile(const profile_t *profile, float *max_speed) {
+    physics_config_t config;
+    reference_config_t reference_config;
+    physics_config_for_step(&config, STEP_US);
+    reference_config_for_step(&reference_config, STEP_US);
+
+    physics_ball_t ball;
+    physics_ball_reset(&ball, FIX_FROM_INT(64), FIX_FROM_INT(32));
+    reference_ball_t reference = {64.0f, 32.0f, 0.0f, 0.0f};
+
+    float max_error = 0.0f;
+    *max_speed = 0.0f;
+    for (int step = 0; step < STEPS; step++) {
+        int16_t raw_x, raw_y;
+        profile->accel(step, &raw_x, &raw_y);
+
+        physics_ball_accelerate(&ball, &config, physics_accel_from_raw(raw_x, PHYSICS_ACCEL_SHIFT_2G),
+                                physics_accel_from_raw(raw_y, PHYSICS_ACCEL_SHIFT_2G));
+        fixed_move(&ball.x, &ball.vel_x, config.bounce, BOX_MAX_X);
+        fixed_move(&ball.y, &ball.vel_y, config.bounce, BOX_MAX_Y);
+
+        reference.vel_x += raw_x / 16384.0f * reference_config.gravity;
+        reference.vel_y += raw_y / 16384.0f * reference_config.gravity;
+        reference.vel_x *= reference_config.damping;
+        reference.vel_y *= reference_config.damping;
+        reference_move(&reference.x, &reference.vel_x, reference_config.bounce, BOX_MAX_X);
+        reference_move(&reference.y, &reference.vel_y, reference_config.bounce, BOX_MAX_Y);
+
+        float error = hypotf(FIX_TO_FLOAT(ball.x) - reference.x, FIX_TO_FLOAT(ball.y) - reference.y);
+        if (error > max_error) max_error = error;
+        float speed = hypotf(reference.vel_x, reference.vel_y) * (1e6f / STEP_US);
+        if (speed > *max_speed) *max_speed = speed;
+
+        if ((step + 1) % WINDOW == 0) {
+            ball.x = FIX_FROM_FLOAT(reference.x);
+            ball.y = FIX_FROM_FLOAT(reference.y);
+            ball.vel_x = FIX_FROM_FLOAT(reference.vel_x);
+            ball.vel_y = FIX_FROM_FLOAT(reference.vel_y);
+        }
+    }
+    return max_error;
+}
+
+int main(void) {
+    printf("Q%d.%d, passo de %d us, %d passos por perfil, janelas de %d passos, tolerância %.2f px\n",
+           31 - PHYSICS_FRAC_BITS, PHYSICS_FRAC_BITS, STEP_US, STEPS, WINDOW, TOLERANCE_PX);
+
+    int failures = 0;
+    for (size_t i = 0; i < PROFILE_COUNT; i++) {
+        float max_speed;
+        float error = run_profile(&profiles[i], &max_speed);
+        bool ok = error <= TOLERANCE_PX;
+        printf("%-10s erro máximo %.4f px (velocidade até %.1f px/s) %s\n", profiles[i].name, error, max_speed,
+               ok ? "ok" : "FALHOU");
+        if (!ok) failures++;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
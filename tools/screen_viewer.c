@@ -0,0 +1,162 @@
+/*
+* Visualizador do espelho da tela (include/screen_mirror.h) no computador
+* Lê a telemetria do USB (ou uma captura gravada), aplica os trechos de página
+* TELEMETRY_SCREEN numa cópia de 128x64 e redesenha no terminal a cada tela
+* nova, dois pixels por caractere. Os outros registros são ignorados.
+*
+* gcc -O2 -Iinclude tools/screen_viewer.c -o screen_viewer
+* ./screen_viewer /dev/ttyACM0
+* ./screen_viewer --pbm telas captura.bin   (grava telas/screen_NNNNN.pbm em vez de desenhar)
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "telemetry.h"
+
+#define WIDTH 128
+#define HEIGHT 64
+
+static uint8_t screen[WIDTH * HEIGHT / 8];
+static bool have_frame;
+static uint16_t current_frame;
+static unsigned long shown;
+static const char *pbm_dir;
+
+static bool pixel(int x, int y) {
+    return (screen[(y / 8) * WIDTH + x] >> (y % 8)) & 1;
+}
+
+static void draw_terminal(void) {
+    // volta o cursor para o canto em vez de limpar (não pisca)
+    printf("\033[H");
+    for (int y = 0; y < HEIGHT; y += 2) {
+        for (int x = 0; x < WIDTH; x++) {
+            bool top = pixel(x, y);
+            bool bottom = pixel(x, y + 1);
+            fputs(top ? (bottom ? "█" : "▀") : (bottom ? "▄" : " "), stdout);
+        }
+        putchar('\n');
+    }
+    printf("tela #%u\033[K\n", current_frame);
+    fflush(stdout);
+}
+
+static void write_pbm(void) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/screen_%05lu.pbm", pbm_dir, shown);
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        exit(1);
+    }
+    // como no host/sim.c: PBM binário, com o pixel aceso branco
+    fprintf(file, "P4\n%d %d\n", WIDTH, HEIGHT);
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x += 8) {
+            uint8_t packed = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                if (!pixel(x + bit, y)) packed |= (uint8_t)(0x80 >> bit);
+            }
+            fputc(packed, file);
+        }
+    }
+    fclose(file);
+}
+
+// a tela anterior está completa quando chega o primeiro trecho da seguinte
+static void show(void) {
+    if (pbm_dir) {
+        write_pbm();
+    } else {
+        draw_terminal();
+    }
+    shown++;
+}
+
+static void apply(const telemetry_screen_t *record, int count) {
+    if (have_frame && record->frame != current_frame) show();
+    have_frame = true;
+    current_frame = record->frame;
+
+    if (record->page >= HEIGHT / 8 || record->column + count > WIDTH) return;
+    memcpy(&screen[record->page * WIDTH + record->column], record->data, count);
+}
+
+// mesmo enquadramento do tools/telemetry_decode.c, sem as contagens
+static size_t decode(const uint8_t *buffer, size_t length) {
+    size_t pos = 0;
+
+    while (length - pos >= TELEMETRY_HEADER_SIZE + TELEMETRY_TRAILER_SIZE) {
+        const uint8_t *frame = buffer + pos;
+        uint8_t size = frame[3];
+        if (frame[0] != TELEMETRY_SYNC0 || frame[1] != TELEMETRY_SYNC1 || size > TELEMETRY_MAX_DIRECT_PAYLOAD) {
+            pos++;
+            continue;
+        }
+
+        size_t total = TELEMETRY_HEADER_SIZE + size + TELEMETRY_TRAILER_SIZE;
+        if (length - pos < total) break;
+
+        uint16_t crc = telemetry_crc16(0xFFFF, frame + 2, TELEMETRY_HEADER_SIZE - 2 + size);
+        if (crc != (uint16_t)(frame[total - 2] | (frame[total - 1] << 8))) {
+            pos++;
+            continue;
+        }
+
+        if (frame[2] == TELEMETRY_SCREEN && size > TELEMETRY_SCREEN_HEADER_SIZE) {
+            telemetry_screen_t record;
+            memcpy(&record, frame + TELEMETRY_HEADER_SIZE, size);
+            apply(&record, size - TELEMETRY_SCREEN_HEADER_SIZE);
+        }
+        pos += total;
+    }
+    return pos;
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pbm") == 0 && i + 1 < argc) {
+            pbm_dir = argv[++i];
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "uso: %s [--pbm DIR] <arquivo ou porta serial>\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    if (isatty(fd)) {
+        struct termios tty;
+        if (tcgetattr(fd, &tty) == 0) {
+            cfmakeraw(&tty);
+            tcsetattr(fd, TCSANOW, &tty);
+        }
+    }
+    if (!pbm_dir) printf("\033[2J");
+
+    static uint8_t buffer[8192];
+    size_t used = 0;
+    ssize_t got;
+    while ((got = read(fd, buffer + used, sizeof(buffer) - used)) > 0) {
+        used += (size_t)got;
+        size_t consumed = decode(buffer, used);
+        memmove(buffer, buffer + consumed, used - consumed);
+        used -= consumed;
+    }
+    close(fd);
+
+    // a última tela não tem uma seguinte para fechá-la
+    if (have_frame) show();
+    fprintf(stderr, "%lu telas\n", shown);
+    return 0;
+}
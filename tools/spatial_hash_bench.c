@@ -0,0 +1,84 @@
+/*
+* Benchmark da grade de vizinhança no computador (não roda na placa)
+* Mede a reconstrução (células + ordenação por contagem) e a busca de
+* vizinhos de todos os corpos, comparando com o teste de todos os pares.
+*
+* gcc -O2 -Iinclude tools/spatial_hash_bench.c include/spatial_hash.c -o spatial_hash_bench
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "spatial_hash.h"
+
+#define MAX_BODIES 2000
+#define REPEAT 200
+
+// mundo de 256x128 pixels com células de 4 pixels e raio de interação de 4 pixels
+#define WORLD_WIDTH 256
+#define WORLD_HEIGHT 128
+#define CELL_SHIFT 2
+#define GRID_WIDTH (WORLD_WIDTH >> CELL_SHIFT)
+#define GRID_HEIGHT (WORLD_HEIGHT >> CELL_SHIFT)
+#define INTERACTION FIX_FROM_INT(1 << CELL_SHIFT)
+
+static fix_t body_x[MAX_BODIES];
+static fix_t body_y[MAX_BODIES];
+static uint16_t cell_start[GRID_WIDTH * GRID_HEIGHT + 1];
+static uint16_t sorted[MAX_BODIES];
+static uint16_t body_cell[MAX_BODIES];
+
+static double now_us(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+static inline int close_enough(int i, int j) {
+    int64_t dx = body_x[j] - body_x[i];
+    int64_t dy = body_y[j] - body_y[i];
+    return dx * dx + dy * dy < (int64_t)INTERACTION * INTERACTION;
+}
+
+int main(void) {
+    static const int counts[] = {100, 250, 500, 1000, 2000};
+    spatial_hash_t hash;
+    spatial_hash_init(&hash, cell_start, sorted, body_cell, MAX_BODIES, GRID_WIDTH, GRID_HEIGHT, CELL_SHIFT);
+    srand(1);
+
+    printf("corpos  montagem (us)  vizinhos (us)  pares     todos os pares (us)\n");
+    for (unsigned c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+        int count = counts[c];
+        for (int i = 0; i < count; i++) {
+            body_x[i] = rand() % FIX_FROM_INT(WORLD_WIDTH);
+            body_y[i] = rand() % FIX_FROM_INT(WORLD_HEIGHT);
+        }
+
+        double start = now_us();
+        for (int r = 0; r < REPEAT; r++) spatial_hash_build(&hash, body_x, body_y, 1, count);
+        double build_us = (now_us() - start) / REPEAT;
+
+        long pairs = 0;
+        start = now_us();
+        for (int r = 0; r < REPEAT; r++) {
+            pairs = 0;
+            for (int i = 0; i < count; i++) {
+                SPATIAL_HASH_FOR_EACH_NEAR(&hash, hash.body_cell[i], j, {
+                    if (j > i && close_enough(i, j)) pairs++;
+                });
+            }
+        }
+        double query_us = (now_us() - start) / REPEAT;
+
+        // referência O(n²), que também confere a contagem de pares
+        long brute_pairs = 0;
+        start = now_us();
+        for (int i = 0; i < count; i++) {
+            for (int j = i + 1; j < count; j++) brute_pairs += close_enough(i, j);
+        }
+        double brute_us = now_us() - start;
+
+        printf("%6d  %13.1f  %13.1f  %-8ld  %10.1f%s\n", count, build_us, query_us, pairs, brute_us,
+               pairs == brute_pairs ? "" : "  (DIVERGE)");
+    }
+    return 0;
+}
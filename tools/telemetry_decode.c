@@ -0,0 +1,162 @@
+/*
+* Decodificador da telemetria binária (include/telemetry.h) no computador
+* Lê de um arquivo ou direto da porta serial do USB (ex.: /dev/ttyACM0),
+* procura os quadros pelos bytes de sincronismo, confere o CRC e imprime um
+* registro por linha. O texto do printf misturado no canal é ignorado.
+*
+* gcc -O2 -Iinclude tools/telemetry_decode.c -o telemetry_decode
+* ./telemetry_decode /dev/ttyACM0          (ou um arquivo gravado)
+* ./telemetry_decode --summary captura.bin (só as contagens no final)
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "telemetry.h"
+
+#define FIX_ONE (1 << 16)
+
+static bool summary_only;
+
+static struct {
+    unsigned long records[TELEMETRY_SCREEN + 1];
+    unsigned long crc_errors;
+    unsigned long lost;           // pelas lacunas na sequência
+    unsigned long skipped_bytes;  // texto e lixo entre os quadros
+} counts;
+
+static void print_record(uint8_t type, const uint8_t *payload, uint8_t length) {
+    if (summary_only) return;
+
+    if (type == TELEMETRY_SENSOR && length == sizeof(telemetry_sensor_t)) {
+        telemetry_sensor_t r;
+        memcpy(&r, payload, sizeof(r));
+        printf("sensor %10lu accel %6d %6d %6d gyro %6d %6d %6d temp %6d\n", (unsigned long)r.time_us,
+               r.accel[0], r.accel[1], r.accel[2], r.gyro[0], r.gyro[1], r.gyro[2], r.temperature);
+    } else if (type == TELEMETRY_BALL && length == sizeof(telemetry_ball_t)) {
+        telemetry_ball_t r;
+        memcpy(&r, payload, sizeof(r));
+        printf("bola   %10lu #%u pos %8.3f %8.3f vel %8.4f %8.4f\n", (unsigned long)r.time_us, r.index,
+               (double)r.x / FIX_ONE, (double)r.y / FIX_ONE, (double)r.vel_x / FIX_ONE, (double)r.vel_y / FIX_ONE);
+    } else if (type == TELEMETRY_FRAME && length == sizeof(telemetry_frame_t)) {
+        telemetry_frame_t r;
+        memcpy(&r, payload, sizeof(r));
+        printf("quadro %10lu %6lu us passos %3u sensor %u atrasos %lu descartados %lu\n", (unsigned long)r.time_us,
+               (unsigned long)r.frame_us, r.physics_steps, r.sensor_steps, (unsigned long)r.missed_deadlines,
+               (unsigned long)r.dropped_records);
+    } else if (type == TELEMETRY_ERRORS && length == sizeof(telemetry_errors_t)) {
+        telemetry_errors_t r;
+        memcpy(&r, payload, sizeof(r));
+        printf("erros  %10lu sensor %lu (tempo %u, recuperado %u) display %lu (tempo %u, recuperado %u) botoes %lu\n",
+               (unsigned long)r.time_us, (unsigned long)r.sensor_errors, r.sensor_timeouts, r.sensor_recoveries,
+               (unsigned long)r.display_errors, r.display_timeouts, r.display_recoveries,
+               (unsigned long)r.button_dropped);
+    } else if (type == TELEMETRY_SCREEN && length > TELEMETRY_SCREEN_HEADER_SIZE) {
+        telemetry_screen_t r;
+        memcpy(&r, payload, length);
+        printf("tela   #%u pagina %u colunas %u..%u\n", r.frame, r.page, r.column,
+               r.column + length - TELEMETRY_SCREEN_HEADER_SIZE - 1);
+    } else {
+        printf("tipo %u desconhecido (%u bytes)\n", type, length);
+    }
+}
+
+// Consome os quadros completos de buffer e retorna quantos bytes foram usados
+static size_t decode(const uint8_t *buffer, size_t length) {
+    static bool have_sequence;
+    static uint16_t expected;
+    size_t pos = 0;
+
+    while (length - pos >= TELEMETRY_HEADER_SIZE + TELEMETRY_TRAILER_SIZE) {
+        if (buffer[pos] != TELEMETRY_SYNC0 || buffer[pos + 1] != TELEMETRY_SYNC1) {
+            pos++;
+            counts.skipped_bytes++;
+            continue;
+        }
+
+        uint8_t type = buffer[pos + 2];
+        uint8_t size = buffer[pos + 3];
+        if (size > TELEMETRY_MAX_DIRECT_PAYLOAD) {
+            pos++;
+            counts.skipped_bytes++;
+            continue;
+        }
+
+        size_t total = TELEMETRY_HEADER_SIZE + size + TELEMETRY_TRAILER_SIZE;
+        if (length - pos < total) break;  // espera o resto
+
+        const uint8_t *frame = buffer + pos;
+        uint16_t crc = telemetry_crc16(0xFFFF, frame + 2, TELEMETRY_HEADER_SIZE - 2 + size);
+        uint16_t stored = (uint16_t)(frame[total - 2] | (frame[total - 1] << 8));
+        if (crc != stored) {
+            // sincronismo falso (ou quadro corrompido): tenta a partir do próximo byte
+            counts.crc_errors++;
+            pos++;
+            continue;
+        }
+
+        uint16_t sequence = (uint16_t)(frame[4] | (frame[5] << 8));
+        if (have_sequence && sequence != expected) counts.lost += (uint16_t)(sequence - expected);
+        have_sequence = true;
+        expected = (uint16_t)(sequence + 1);
+
+        if (type <= TELEMETRY_SCREEN) counts.records[type]++;
+        print_record(type, frame + TELEMETRY_HEADER_SIZE, size);
+        pos += total;
+    }
+    return pos;
+}
+
+// porta serial em modo cru (sem eco nem tradução de fim de linha)
+static void configure_serial(int fd) {
+    struct termios tty;
+    if (tcgetattr(fd, &tty) != 0) return;
+    cfmakeraw(&tty);
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--summary") == 0) {
+            summary_only = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "uso: %s [--summary] <arquivo ou porta serial>\n", argv[0]);
+        return 2;
+    }
+
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    if (isatty(fd)) configure_serial(fd);
+
+    static uint8_t buffer[8192];
+    size_t used = 0;
+    ssize_t got;
+    while ((got = read(fd, buffer + used, sizeof(buffer) - used)) > 0) {
+        used += (size_t)got;
+        size_t consumed = decode(buffer, used);
+        memmove(buffer, buffer + consumed, used - consumed);
+        used -= consumed;
+        if (!summary_only) fflush(stdout);
+    }
+    close(fd);
+
+    printf("registros: sensor %lu, bola %lu, quadro %lu, erros %lu, tela %lu\n",
+           counts.records[TELEMETRY_SENSOR], counts.records[TELEMETRY_BALL],
+           counts.records[TELEMETRY_FRAME], counts.records[TELEMETRY_ERRORS],
+           counts.records[TELEMETRY_SCREEN]);
+    printf("perdidos: %lu, falhas de CRC: %lu, bytes ignorados: %lu\n",
+           counts.lost, counts.crc_errors, counts.skipped_bytes + used);
+    return 0;
+}